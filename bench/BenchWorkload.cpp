@@ -0,0 +1,169 @@
+#include "BenchWorkload.h"
+#include "XmlNumericCodec.h"
+#include <map>
+#include <tuple>
+
+namespace
+{
+    enum class FieldKind { Text, Int, Double };
+
+    // Spreads the text fields evenly over the record
+    FieldKind fieldKind(const BenchShape& shape, size_t field)
+    {
+        size_t textBefore = static_cast<size_t>(field * shape.textRatio);
+        size_t textAfter = static_cast<size_t>((field + 1) * shape.textRatio);
+        if (textAfter > textBefore)
+            return FieldKind::Text;
+        return (field - textBefore) % 2 == 0 ? FieldKind::Int : FieldKind::Double;
+    }
+
+    std::string fieldName(size_t field)
+    {
+        return "Field" + std::to_string(field);
+    }
+
+    std::string textValue(size_t index, size_t level, size_t field)
+    {
+        return "Value " + std::to_string(index) + "-" + std::to_string(level) + "-" + std::to_string(field);
+    }
+
+    int intValue(size_t index, size_t level, size_t field)
+    {
+        return static_cast<int>((index * 31 + level * 7 + field) % 100000);
+    }
+
+    double doubleValue(size_t index, size_t level, size_t field)
+    {
+        return static_cast<double>(index % 1000) + static_cast<double>(level * 10 + field) / 64.0;
+    }
+
+    void appendLevel(std::string& text, const BenchShape& shape, size_t index, size_t level, int indent)
+    {
+        std::string padding(static_cast<size_t>(indent) * 4, ' ');
+        char number[XmlNumericCodec::BufferSize];
+        for (size_t field = 0; field < shape.fields; ++field)
+        {
+            std::string name = fieldName(field);
+            text += padding + "<" + name + ">";
+            switch (fieldKind(shape, field))
+            {
+            case FieldKind::Text:
+                text += textValue(index, level, field);
+                break;
+            case FieldKind::Int:
+                XmlNumericCodec::format(number, sizeof(number), intValue(index, level, field));
+                text += number;
+                break;
+            case FieldKind::Double:
+                XmlNumericCodec::format(number, sizeof(number), doubleValue(index, level, field));
+                text += number;
+                break;
+            }
+            text += "</" + name + ">\n";
+        }
+        if (level + 1 < shape.depth)
+        {
+            text += padding + "<Nested>\n";
+            appendLevel(text, shape, index, level + 1, indent + 1);
+            text += padding + "</Nested>\n";
+        }
+    }
+}
+
+BenchShape BenchRecord::s_defaultShape;
+
+BenchRecord::BenchRecord() : BenchRecord(s_defaultShape) {}
+
+BenchRecord::BenchRecord(const BenchShape& shape, size_t level)
+    : XMLSerializable(layout(shape, level)), m_shape(shape), m_level(level)
+{
+}
+
+void BenchRecord::fill(size_t index)
+{
+    for (size_t field = 0; field < m_shape.fields; ++field)
+    {
+        switch (fieldKind(m_shape, field))
+        {
+        case FieldKind::Text:
+            addData(fieldName(field), textValue(index, m_level, field));
+            break;
+        case FieldKind::Int:
+            addData(fieldName(field), intValue(index, m_level, field));
+            break;
+        case FieldKind::Double:
+            addData(fieldName(field), doubleValue(index, m_level, field));
+            break;
+        }
+    }
+    if (BenchRecord* nested = getDataPtr<BenchRecord>("Nested"))
+        nested->fill(index);
+}
+
+std::shared_ptr<const XmlFieldLayout> BenchRecord::layout(const BenchShape& shape, size_t level)
+{
+    // The benchmark is single-threaded, so the cache needs no lock
+    static std::map<std::tuple<size_t, size_t, double, size_t>, std::shared_ptr<const XmlFieldLayout>> layouts;
+    auto key = std::make_tuple(shape.fields, shape.depth, shape.textRatio, level);
+    auto found = layouts.find(key);
+    if (found != layouts.end())
+        return found->second;
+
+    auto layout = std::make_shared<XmlFieldLayout>();
+    for (size_t field = 0; field < shape.fields; ++field)
+    {
+        switch (fieldKind(shape, field))
+        {
+        case FieldKind::Text:
+            layout->add(fieldName(field), std::string());
+            break;
+        case FieldKind::Int:
+            layout->add(fieldName(field), 0);
+            break;
+        case FieldKind::Double:
+            layout->add(fieldName(field), 0.0);
+            break;
+        }
+    }
+    if (level + 1 < shape.depth)
+        layout->add("Nested", BenchRecord(shape, level + 1));
+    layouts[key] = layout;
+    return layout;
+}
+
+BenchWorkload::BenchWorkload(const BenchShape& shape) : m_shape(shape)
+{
+    BenchRecord::s_defaultShape = shape;
+}
+
+std::string BenchWorkload::generate() const
+{
+    std::string text;
+    text.reserve(m_shape.records * m_shape.fieldsPerRecord() * 40 + 128);
+    text += "<Imput>\n    <LocationSet>\n        <PlatformSet>\n";
+    for (size_t index = 0; index < m_shape.records; ++index)
+    {
+        text += "            <Platform>\n";
+        appendLevel(text, m_shape, index, 0, 4);
+        text += "            </Platform>\n";
+    }
+    text += "        </PlatformSet>\n    </LocationSet>\n</Imput>\n";
+    return text;
+}
+
+std::vector<BenchRecord> BenchWorkload::records() const
+{
+    std::vector<BenchRecord> records(m_shape.records, record());
+    for (size_t index = 0; index < records.size(); ++index)
+        records[index].fill(index);
+    return records;
+}
+
+BenchRecord BenchWorkload::record() const
+{
+    return BenchRecord(m_shape);
+}
+
+const BenchShape& BenchWorkload::shape() const { return m_shape; }
+
+const char* BenchWorkload::recordPath() { return "Imput/LocationSet/PlatformSet/Platform"; }
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "XMLSerializable.h"
+#include "XmlFieldLayout.h"
+
+// Shape of a synthetic document modelled on complex_example2_input.xml:
+//
+//     <Imput><LocationSet><PlatformSet>
+//         <Platform>                      N records
+//             <Field0>..</Field0>         F fields per level, text or number
+//             <Nested>...</Nested>        D levels in total
+//         </Platform>
+//     </PlatformSet></LocationSet></Imput>
+struct BenchShape
+{
+    size_t records = 10000;
+    size_t fields = 10;
+    size_t depth = 1;
+    double textRatio = 0.3;     // Share of fields holding text; the rest alternate int and double
+
+    size_t fieldsPerRecord() const { return fields * depth; }
+};
+
+// Record of a given shape. Each nesting level has its own field layout, shared by all records.
+class BenchRecord : public XMLSerializable
+{
+public:
+    // Default-constructed records, such as those XmlParallel creates, take the shape of the
+    // most recently constructed BenchWorkload
+    BenchRecord();
+    BenchRecord(const BenchShape& shape, size_t level = 0);
+
+    // Fills the fields with deterministic values derived from index
+    void fill(size_t index);
+
+private:
+    BenchShape m_shape;
+    size_t m_level;
+
+    static BenchShape s_defaultShape;
+
+    static std::shared_ptr<const XmlFieldLayout> layout(const BenchShape& shape, size_t level);
+
+    friend class BenchWorkload;
+};
+
+class BenchWorkload
+{
+public:
+    explicit BenchWorkload(const BenchShape& shape);
+
+    // Complete document text
+    std::string generate() const;
+    // Records in the same state as after deserializing generate()
+    std::vector<BenchRecord> records() const;
+    BenchRecord record() const;
+
+    const BenchShape& shape() const;
+
+    static const char* recordPath();
+
+private:
+    BenchShape m_shape;
+};
@@ -0,0 +1,278 @@
+#include "BenchWorkload.h"
+#include "XmlParallel.h"
+#include "tinyxml2.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    struct Options
+    {
+        BenchShape shape;
+        size_t iterations = 5;
+        bool parallel = false;
+        bool json = false;
+        std::string output = "tinyxmlhelper_bench.xml";
+    };
+
+    struct PhaseResult
+    {
+        std::string name;
+        double seconds = 0;         // Best of all iterations
+        size_t peakRssKb = 0;       // Peak resident set while the phase ran
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: tinyxmlhelper_bench [options]\n"
+                  << "  --records N       Records per document (default 10000)\n"
+                  << "  --fields F        Fields per nesting level (default 10)\n"
+                  << "  --depth D         Nesting levels per record (default 1)\n"
+                  << "  --text-ratio R    Share of text fields, 0 to 1 (default 0.3)\n"
+                  << "  --iterations K    Runs per phase, the best is reported (default 5)\n"
+                  << "  --parallel        Use XmlParallel for the record collection\n"
+                  << "  --json            Print the results as JSON\n"
+                  << "  --output FILE     File written by the save phase\n";
+    }
+
+    bool parseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--records" && hasValue)
+                options.shape.records = std::strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--fields" && hasValue)
+                options.shape.fields = std::strtoul(argv[++i], nullptr, 10);
+            else if (arg == "--depth" && hasValue)
+                options.shape.depth = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+            else if (arg == "--text-ratio" && hasValue)
+                options.shape.textRatio = std::min(1.0, std::max(0.0, std::strtod(argv[++i], nullptr)));
+            else if (arg == "--iterations" && hasValue)
+                options.iterations = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+            else if (arg == "--output" && hasValue)
+                options.output = argv[++i];
+            else if (arg == "--parallel")
+                options.parallel = true;
+            else if (arg == "--json")
+                options.json = true;
+            else
+                return false;
+        }
+        return true;
+    }
+
+    // Restarts peak tracking where the platform allows it, so each phase reports its own peak
+    void resetPeakRss()
+    {
+#ifdef __linux__
+        std::ofstream clearRefs("/proc/self/clear_refs");
+        clearRefs << "5";
+#endif
+    }
+
+    size_t peakRssKb()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return counters.PeakWorkingSetSize / 1024;
+        return 0;
+#else
+#ifdef __linux__
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line))
+        {
+            if (line.compare(0, 6, "VmHWM:") == 0)
+                return std::strtoul(line.c_str() + 6, nullptr, 10);
+        }
+#endif
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+#ifdef __APPLE__
+        return static_cast<size_t>(usage.ru_maxrss) / 1024;    // Bytes on macOS
+#else
+        return static_cast<size_t>(usage.ru_maxrss);
+#endif
+#endif
+    }
+
+    // Runs setup outside and body inside the timed region, keeping the fastest run
+    PhaseResult measure(const char* name, size_t iterations, const std::function<void()>& setup,
+        const std::function<bool()>& body)
+    {
+        PhaseResult result;
+        result.name = name;
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            setup();
+            resetPeakRss();
+            auto start = std::chrono::steady_clock::now();
+            bool success = body();
+            auto stop = std::chrono::steady_clock::now();
+            if (!success)
+            {
+                std::cerr << "Phase " << name << " failed" << std::endl;
+                std::exit(EXIT_FAILURE);
+            }
+            double seconds = std::chrono::duration<double>(stop - start).count();
+            if (i == 0 || seconds < result.seconds)
+                result.seconds = seconds;
+            result.peakRssKb = std::max(result.peakRssKb, peakRssKb());
+        }
+        return result;
+    }
+
+    tinyxml2::XMLElement* recordParent(tinyxml2::XMLDocument& document)
+    {
+        tinyxml2::XMLElement* element = document.RootElement();
+        element = element ? element->FirstChildElement("LocationSet") : nullptr;
+        return element ? element->FirstChildElement("PlatformSet") : nullptr;
+    }
+
+    bool deserializeRecords(tinyxml2::XMLElement* parent, std::vector<BenchRecord>& records, bool parallel)
+    {
+        if (!parent)
+            return false;
+        if (parallel)
+            return XmlParallel::deserialize(parent, "Platform", records);
+
+        bool success = true;
+        size_t index = 0;
+        for (tinyxml2::XMLElement* element = parent->FirstChildElement("Platform"); element;
+             element = element->NextSiblingElement("Platform"))
+        {
+            if (index == records.size())
+                return false;
+            success = records[index++].deserialize(element) && success;
+        }
+        return success && index == records.size();
+    }
+
+    bool serializeRecords(tinyxml2::XMLDocument& document, const std::vector<BenchRecord>& records, bool parallel)
+    {
+        tinyxml2::XMLElement* root = document.NewElement("Imput");
+        document.InsertEndChild(root);
+        tinyxml2::XMLElement* locationSet = root->InsertNewChildElement("LocationSet");
+        tinyxml2::XMLElement* parent = locationSet->InsertNewChildElement("PlatformSet");
+        if (parallel)
+            return XmlParallel::serialize(parent, "Platform", records);
+
+        bool success = true;
+        for (const BenchRecord& record : records)
+            success = record.serialize(parent->InsertNewChildElement("Platform")) && success;
+        return success;
+    }
+
+    void printText(const Options& options, size_t bytes, const std::vector<PhaseResult>& results)
+    {
+        const BenchShape& shape = options.shape;
+        std::printf("records=%zu fields=%zu depth=%zu text-ratio=%.2f iterations=%zu%s document=%.2f MB\n",
+            shape.records, shape.fields, shape.depth, shape.textRatio, options.iterations,
+            options.parallel ? " parallel" : "", bytes / 1e6);
+        std::printf("%-12s %12s %14s %10s %12s %14s\n", "phase", "seconds", "records/s", "MB/s", "ns/field", "peak RSS KB");
+        for (const PhaseResult& result : results)
+        {
+            double fields = static_cast<double>(shape.records * shape.fieldsPerRecord());
+            std::printf("%-12s %12.6f %14.0f %10.1f %12.1f %14zu\n", result.name.c_str(), result.seconds,
+                shape.records / result.seconds, bytes / 1e6 / result.seconds,
+                fields > 0 ? result.seconds * 1e9 / fields : 0.0, result.peakRssKb);
+        }
+    }
+
+    void printJson(const Options& options, size_t bytes, const std::vector<PhaseResult>& results)
+    {
+        const BenchShape& shape = options.shape;
+        std::ostringstream json;
+        json.precision(9);
+        json << "{\n  \"records\": " << shape.records
+             << ",\n  \"fields\": " << shape.fields
+             << ",\n  \"depth\": " << shape.depth
+             << ",\n  \"textRatio\": " << shape.textRatio
+             << ",\n  \"iterations\": " << options.iterations
+             << ",\n  \"parallel\": " << (options.parallel ? "true" : "false")
+             << ",\n  \"documentBytes\": " << bytes
+             << ",\n  \"phases\": [";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const PhaseResult& result = results[i];
+            double fields = static_cast<double>(shape.records * shape.fieldsPerRecord());
+            json << (i == 0 ? "\n" : ",\n")
+                 << "    {\"name\": \"" << result.name << "\""
+                 << ", \"seconds\": " << result.seconds
+                 << ", \"recordsPerSecond\": " << shape.records / result.seconds
+                 << ", \"megabytesPerSecond\": " << bytes / 1e6 / result.seconds
+                 << ", \"nanosecondsPerField\": " << (fields > 0 ? result.seconds * 1e9 / fields : 0.0)
+                 << ", \"peakRssKb\": " << result.peakRssKb << "}";
+        }
+        json << "\n  ]\n}\n";
+        std::cout << json.str();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    BenchWorkload workload(options.shape);
+    const std::string text = workload.generate();
+    const std::vector<BenchRecord> expected = workload.records();
+    std::vector<PhaseResult> results;
+
+    // Each phase starts from the previous phase's output, built outside the timed region
+    tinyxml2::XMLDocument parsed;
+    results.push_back(measure("parse", options.iterations,
+        [&] { parsed.Clear(); },
+        [&] { return parsed.Parse(text.data(), text.size()) == tinyxml2::XML_SUCCESS; }));
+
+    std::vector<BenchRecord> records;
+    results.push_back(measure("deserialize", options.iterations,
+        [&] { records.assign(options.shape.records, workload.record()); },
+        [&] { return deserializeRecords(recordParent(parsed), records, options.parallel); }));
+
+    tinyxml2::XMLDocument serialized;
+    results.push_back(measure("serialize", options.iterations,
+        [&] { serialized.Clear(); },
+        [&] { return serializeRecords(serialized, expected, options.parallel); }));
+
+    results.push_back(measure("save", options.iterations,
+        [] {},
+        [&] { return serialized.SaveFile(options.output.c_str()) == tinyxml2::XML_SUCCESS; }));
+    std::remove(options.output.c_str());
+
+    if (options.json)
+        printJson(options, text.size(), results);
+    else
+        printText(options, text.size(), results);
+    return EXIT_SUCCESS;
+}
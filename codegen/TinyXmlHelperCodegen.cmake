@@ -0,0 +1,39 @@
+# tinyxmlhelper_generate(<target> INPUT <file> OUTPUT <header> [SCHEMA] [NAMESPACE <name>])
+#
+# Generates <header> from the sample document (or, with SCHEMA, the schema) <file> at build time
+# and makes it available to <target>. A relative OUTPUT is placed under the current binary
+# directory, which is added to the target's include path. The header is regenerated whenever the
+# input or the generator changes.
+function(tinyxmlhelper_generate target)
+    cmake_parse_arguments(ARG "SCHEMA" "INPUT;OUTPUT;NAMESPACE" "" ${ARGN})
+    if(NOT ARG_INPUT OR NOT ARG_OUTPUT)
+        message(FATAL_ERROR "tinyxmlhelper_generate: INPUT and OUTPUT are required")
+    endif()
+    if(NOT TARGET tinyxmlhelper_codegen)
+        message(FATAL_ERROR "tinyxmlhelper_generate: the tinyxmlhelper_codegen target is not built (BUILD_CODEGEN)")
+    endif()
+
+    get_filename_component(input "${ARG_INPUT}" ABSOLUTE)
+    get_filename_component(output "${ARG_OUTPUT}" ABSOLUTE BASE_DIR "${CMAKE_CURRENT_BINARY_DIR}")
+    get_filename_component(output_dir "${output}" DIRECTORY)
+
+    set(arguments)
+    if(ARG_SCHEMA)
+        list(APPEND arguments --schema)
+    endif()
+    if(ARG_NAMESPACE)
+        list(APPEND arguments --namespace ${ARG_NAMESPACE})
+    endif()
+
+    add_custom_command(
+        OUTPUT "${output}"
+        COMMAND ${CMAKE_COMMAND} -E make_directory "${output_dir}"
+        COMMAND tinyxmlhelper_codegen ${arguments} "${input}" "${output}"
+        DEPENDS tinyxmlhelper_codegen "${input}"
+        COMMENT "Generating ${ARG_OUTPUT} from ${ARG_INPUT}"
+        VERBATIM
+    )
+    target_sources(${target} PRIVATE "${output}")
+    target_include_directories(${target} PRIVATE "${output_dir}")
+    target_link_libraries(${target} PRIVATE TinyXmlHelper)
+endfunction()
@@ -0,0 +1,700 @@
+#include "XmlNumericCodec.h"
+#include "tinyxml2.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Generates plain C++ structs with straight-line serialize/deserialize functions from a sample XML
+// document or a schema (see printUsage). The output only depends on XmlGenerated.h.
+
+namespace
+{
+    struct Options
+    {
+        bool schema = false;
+        std::string nameSpace;
+        std::string input;
+        std::string output;
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: tinyxmlhelper_codegen [options] INPUT.xml OUTPUT.h\n"
+                  << "  --schema          INPUT is a schema: element text and attribute values are type\n"
+                  << "                    names (int, unsigned, int64, uint64, bool, float, double,\n"
+                  << "                    string) with an optional '?' (optional) or '*' (repeated)\n"
+                  << "                    suffix; xcg:occurs=\"?\" or \"*\" marks elements with children\n"
+                  << "                    or attributes\n"
+                  << "  --namespace NAME  Emit the structs into namespace NAME\n"
+                  << "Without --schema, INPUT is a sample document: types are inferred from the values,\n"
+                  << "elements missing from some instances become optional and elements that repeat\n"
+                  << "within one parent become repeated.\n";
+    }
+
+    bool parseOptions(int argc, char** argv, Options& options)
+    {
+        std::vector<std::string> files;
+        for (int index = 1; index < argc; ++index)
+        {
+            std::string argument = argv[index];
+            if (argument == "--schema")
+                options.schema = true;
+            else if (argument == "--namespace" && index + 1 < argc)
+                options.nameSpace = argv[++index];
+            else if (argument == "--help")
+                return false;
+            else if (!argument.empty() && argument[0] == '-')
+                return false;
+            else
+                files.push_back(argument);
+        }
+        if (files.size() != 2)
+            return false;
+        options.input = files[0];
+        options.output = files[1];
+        return true;
+    }
+
+    enum class Occurrence
+    {
+        Required,
+        Optional,
+        Repeated
+    };
+
+    // Inferred scalar types, ordered so that merging two values takes the wider one
+    enum class Inferred
+    {
+        Unknown,    // Only empty values seen so far
+        Bool,
+        Int,
+        Int64,
+        Double,
+        String
+    };
+
+    Inferred merge(Inferred first, Inferred second)
+    {
+        if (first == Inferred::Unknown)
+            return second;
+        if (second == Inferred::Unknown || first == second)
+            return first;
+        if (first == Inferred::Bool || second == Inferred::Bool)
+            return Inferred::String;
+        return std::max(first, second);
+    }
+
+    Inferred classify(const char* text)
+    {
+        if (!text)
+            return Inferred::Unknown;
+        std::string value = text;
+        value.erase(0, value.find_first_not_of(" \t\r\n"));
+        value.erase(value.find_last_not_of(" \t\r\n") + 1);
+        if (value.empty())
+            return Inferred::Unknown;
+        if (value == "true" || value == "false")
+            return Inferred::Bool;
+        int integer;
+        if (XmlNumericCodec::parse(value.c_str(), integer))
+            return Inferred::Int;
+        int64_t wide;
+        if (XmlNumericCodec::parse(value.c_str(), wide))
+            return Inferred::Int64;
+        double real;
+        if (XmlNumericCodec::parse(value.c_str(), real))
+            return Inferred::Double;
+        return Inferred::String;
+    }
+
+    const char* cppType(Inferred type)
+    {
+        switch (type)
+        {
+        case Inferred::Bool: return "bool";
+        case Inferred::Int: return "int";
+        case Inferred::Int64: return "int64_t";
+        case Inferred::Double: return "double";
+        default: return "std::string";
+        }
+    }
+
+    // Schema type name with its occurrence suffix; false for unknown names
+    bool parseDeclared(const char* text, std::string& type, Occurrence& occurrence)
+    {
+        static const std::map<std::string, std::string> types = {
+            { "int", "int" }, { "unsigned", "unsigned int" }, { "int64", "int64_t" }, { "uint64", "uint64_t" },
+            { "bool", "bool" }, { "float", "float" }, { "double", "double" }, { "string", "std::string" } };
+        std::string name = text ? text : "";
+        name.erase(0, name.find_first_not_of(" \t\r\n"));
+        name.erase(name.find_last_not_of(" \t\r\n") + 1);
+        occurrence = Occurrence::Required;
+        if (!name.empty() && (name.back() == '?' || name.back() == '*'))
+        {
+            occurrence = name.back() == '?' ? Occurrence::Optional : Occurrence::Repeated;
+            name.pop_back();
+        }
+        auto entry = types.find(name);
+        if (entry == types.end())
+            return false;
+        type = entry->second;
+        return true;
+    }
+
+    // A child element or attribute of an element type, as seen across all its instances
+    struct Member
+    {
+        std::string xmlName;
+        bool attribute = false;
+        size_t instances = 0;       // Parent instances containing it
+        size_t maxCount = 0;        // Most occurrences within one parent instance
+        std::string declaredType;   // Schema mode: scalar type of an attribute
+        bool declared = false;      // Schema mode: occurrence given explicitly
+        Occurrence occurrence = Occurrence::Required;
+        Inferred inferred = Inferred::Unknown;  // Attribute values
+    };
+
+    // Everything known about the elements of one name
+    struct ElementInfo
+    {
+        std::string xmlName;
+        size_t instances = 0;
+        bool hasChildren = false;
+        Inferred text = Inferred::Unknown;
+        std::string declaredType;   // Schema mode: scalar type of the text
+        std::vector<Member> members;
+
+        bool isStruct() const
+        {
+            return hasChildren || std::any_of(members.begin(), members.end(), [](const Member& member) { return member.attribute; });
+        }
+
+        Member& member(const std::string& name, bool attribute)
+        {
+            for (Member& existing : members)
+            {
+                if (existing.xmlName == name && existing.attribute == attribute)
+                    return existing;
+            }
+            members.emplace_back();
+            members.back().xmlName = name;
+            members.back().attribute = attribute;
+            return members.back();
+        }
+    };
+
+    class Model
+    {
+    public:
+        explicit Model(bool schema) : m_schema(schema) {}
+
+        bool collect(tinyxml2::XMLElement* element)
+        {
+            ElementInfo& info = this->info(element->Name());
+            ++info.instances;
+
+            std::map<std::string, size_t> counts;
+            for (const tinyxml2::XMLAttribute* attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+            {
+                if (m_schema && std::strcmp(attribute->Name(), "xcg:occurs") == 0)
+                    continue;
+                Member& member = info.member(attribute->Name(), true);
+                ++member.instances;
+                member.maxCount = 1;
+                if (m_schema)
+                {
+                    if (!parseDeclared(attribute->Value(), member.declaredType, member.occurrence) || member.occurrence == Occurrence::Repeated)
+                        return fail(element, std::string("invalid attribute type '") + attribute->Value() + "'");
+                    member.declared = true;
+                }
+                else
+                {
+                    member.inferred = merge(member.inferred, classify(attribute->Value()));
+                }
+            }
+
+            for (tinyxml2::XMLElement* child = element->FirstChildElement(); child; child = child->NextSiblingElement())
+            {
+                info.hasChildren = true;
+                Member& member = this->info(element->Name()).member(child->Name(), false);
+                if (++counts[child->Name()] == 1)
+                    ++member.instances;
+                member.maxCount = std::max(member.maxCount, counts[child->Name()]);
+                if (m_schema && !declareOccurrence(child, member))
+                    return false;
+                if (!collect(child))
+                    return false;
+            }
+
+            ElementInfo& current = this->info(element->Name());
+            if (!current.hasChildren)
+            {
+                const char* text = element->GetText();
+                if (!m_schema)
+                {
+                    current.text = merge(current.text, classify(text));
+                }
+                else if (text || !current.isStruct())
+                {
+                    // Elements with attributes only carry text if a type is given for it
+                    std::string type;
+                    Occurrence ignored;
+                    if (!parseDeclared(text, type, ignored))
+                        return fail(element, std::string("invalid type '") + (text ? text : "") + "'");
+                    current.declaredType = type;
+                }
+            }
+            return true;
+        }
+
+        // Element names in the order they were first seen
+        const std::vector<std::string>& order() const { return m_order; }
+        const ElementInfo& at(const std::string& name) const { return m_infos.at(name); }
+        const std::string& error() const { return m_error; }
+
+    private:
+        bool m_schema;
+        std::map<std::string, ElementInfo> m_infos;
+        std::vector<std::string> m_order;
+        std::string m_error;
+
+        ElementInfo& info(const char* name)
+        {
+            auto entry = m_infos.find(name);
+            if (entry == m_infos.end())
+            {
+                entry = m_infos.emplace(name, ElementInfo()).first;
+                entry->second.xmlName = name;
+                m_order.push_back(name);
+            }
+            return entry->second;
+        }
+
+        bool declareOccurrence(tinyxml2::XMLElement* child, Member& member)
+        {
+            Occurrence occurrence = Occurrence::Required;
+            if (const char* occurs = child->Attribute("xcg:occurs"))
+            {
+                if (std::strcmp(occurs, "?") == 0)
+                    occurrence = Occurrence::Optional;
+                else if (std::strcmp(occurs, "*") == 0)
+                    occurrence = Occurrence::Repeated;
+                else
+                    return fail(child, std::string("invalid xcg:occurs '") + occurs + "'");
+            }
+            else if (!child->FirstChildElement() && !child->FirstAttribute())
+            {
+                std::string type;
+                if (!parseDeclared(child->GetText(), type, occurrence))
+                    return fail(child, std::string("invalid type '") + (child->GetText() ? child->GetText() : "") + "'");
+            }
+            member.occurrence = occurrence;
+            member.declared = true;
+            return true;
+        }
+
+        bool fail(tinyxml2::XMLElement* element, const std::string& message)
+        {
+            m_error = std::string("element <") + element->Name() + "> line " + std::to_string(element->GetLineNum()) + ": " + message;
+            return false;
+        }
+    };
+
+    bool isKeyword(const std::string& name)
+    {
+        static const std::set<std::string> keywords = {
+            "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case", "catch",
+            "char", "char16_t", "char32_t", "class", "compl", "const", "constexpr", "const_cast", "continue",
+            "decltype", "default", "delete", "do", "double", "dynamic_cast", "else", "enum", "explicit", "export",
+            "extern", "false", "float", "for", "friend", "goto", "if", "inline", "int", "long", "mutable",
+            "namespace", "new", "noexcept", "not", "not_eq", "nullptr", "operator", "or", "or_eq", "private",
+            "protected", "public", "register", "reinterpret_cast", "return", "short", "signed", "sizeof", "static",
+            "static_assert", "static_cast", "struct", "switch", "template", "this", "thread_local", "throw", "true",
+            "try", "typedef", "typeid", "typename", "union", "unsigned", "using", "virtual", "void", "volatile",
+            "wchar_t", "while", "xor", "xor_eq",
+            // Names used by the generated code
+            "serialize", "deserialize", "xmlName", "value", "std", "tinyxml2" };
+        return keywords.count(name) != 0;
+    }
+
+    // C++ identifier for an XML name: invalid characters become '_', the first letter is upper case
+    // for types and lower case for members
+    std::string identifier(const std::string& xmlName, bool type)
+    {
+        std::string result;
+        for (char c : xmlName)
+            result += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+        if (result.empty() || !std::isalpha(static_cast<unsigned char>(result[0])))
+            result.insert(0, type ? "E" : "e");
+        if (type)
+        {
+            result[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(result[0])));
+        }
+        else
+        {
+            // A leading acronym is lowered as a whole: ID -> id, URLPath -> urlPath
+            size_t upper = 0;
+            while (upper < result.size() && std::isupper(static_cast<unsigned char>(result[upper])))
+                ++upper;
+            if (upper > 1 && upper < result.size() && std::islower(static_cast<unsigned char>(result[upper])))
+                --upper;
+            for (size_t index = 0; index < std::max<size_t>(upper, 1); ++index)
+                result[index] = static_cast<char>(std::tolower(static_cast<unsigned char>(result[index])));
+        }
+        if (isKeyword(result))
+            result += '_';
+        return result;
+    }
+
+    std::string quoted(const std::string& text)
+    {
+        std::string result = "\"";
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                result += '\\';
+            result += c;
+        }
+        return result + "\"";
+    }
+
+    class Generator
+    {
+    public:
+        Generator(const Model& model, const Options& options) : m_model(model), m_options(options) {}
+
+        bool generate(const std::string& root, std::string& output)
+        {
+            for (const std::string& name : m_model.order())
+            {
+                if (m_model.at(name).isStruct())
+                {
+                    std::string type = identifier(name, true);
+                    while (m_usedTypes.count(type))
+                        type += '_';
+                    m_usedTypes.insert(type);
+                    m_typeNames[name] = type;
+                }
+            }
+            if (!m_model.at(root).isStruct())
+            {
+                m_error = "root element <" + root + "> has no children or attributes";
+                return false;
+            }
+
+            std::ostringstream out;
+            out << "// Generated by tinyxmlhelper_codegen from " << m_options.input << ". Do not edit.\n"
+                << "#pragma once\n"
+                << "#include <cstdint>\n"
+                << "#include <optional>\n"
+                << "#include <string>\n"
+                << "#include <vector>\n"
+                << "#include \"tinyxml2.h\"\n"
+                << "#include \"XmlGenerated.h\"\n\n";
+            if (!m_options.nameSpace.empty())
+                out << "namespace " << m_options.nameSpace << "\n{\n\n";
+
+            // Declared up front so repeated fields may refer to types defined later
+            for (const std::string& name : m_model.order())
+            {
+                if (m_typeNames.count(name))
+                    out << "struct " << m_typeNames[name] << ";\n";
+            }
+            out << "\n";
+
+            std::set<std::string> done;
+            std::set<std::string> active;
+            std::ostringstream definitions;
+            std::ostringstream functions;
+            std::function<bool(const std::string&)> emit = [&](const std::string& name)
+                {
+                    if (done.count(name))
+                        return true;
+                    active.insert(name);
+                    for (const Member& member : m_model.at(name).members)
+                    {
+                        if (member.attribute || !m_typeNames.count(member.xmlName) || occurrence(m_model.at(name), member) == Occurrence::Repeated)
+                            continue;
+                        // Held by value, so it must be complete first
+                        if (active.count(member.xmlName))
+                        {
+                            m_error = "element <" + member.xmlName + "> contains itself without repeating";
+                            return false;
+                        }
+                        if (!emit(member.xmlName))
+                            return false;
+                    }
+                    active.erase(name);
+                    done.insert(name);
+                    emitStruct(m_model.at(name), definitions, functions);
+                    return true;
+                };
+            for (const std::string& name : m_model.order())
+            {
+                if (m_typeNames.count(name) && !emit(name))
+                    return false;
+            }
+
+            out << definitions.str() << functions.str();
+            if (!m_options.nameSpace.empty())
+                out << "} // namespace " << m_options.nameSpace << "\n";
+            output = out.str();
+            return true;
+        }
+
+        const std::string& error() const { return m_error; }
+
+    private:
+        struct Field
+        {
+            const Member* member;
+            std::string name;       // C++ member name
+            std::string type;       // Full C++ member type
+            Occurrence occurrence;
+        };
+
+        const Model& m_model;
+        const Options& m_options;
+        std::map<std::string, std::string> m_typeNames;
+        std::set<std::string> m_usedTypes;
+        std::string m_error;
+
+        Occurrence occurrence(const ElementInfo& parent, const Member& member) const
+        {
+            if (member.declared)
+                return member.occurrence;
+            if (member.maxCount > 1)
+                return Occurrence::Repeated;
+            return member.instances < parent.instances ? Occurrence::Optional : Occurrence::Required;
+        }
+
+        std::string valueType(const Member& member) const
+        {
+            if (member.attribute)
+                return member.declared ? member.declaredType : cppType(member.inferred);
+            auto type = m_typeNames.find(member.xmlName);
+            if (type != m_typeNames.end())
+                return type->second;
+            const ElementInfo& child = m_model.at(member.xmlName);
+            return child.declaredType.empty() ? cppType(child.text) : child.declaredType;
+        }
+
+        std::vector<Field> fields(const ElementInfo& info) const
+        {
+            std::vector<Field> result;
+            std::set<std::string> used = { "value" };
+            for (const Member& member : info.members)
+            {
+                Field field;
+                field.member = &member;
+                field.occurrence = occurrence(info, member);
+                field.name = identifier(member.xmlName, false);
+                while (used.count(field.name))
+                    field.name += '_';
+                used.insert(field.name);
+                std::string type = valueType(member);
+                if (field.occurrence == Occurrence::Optional)
+                    field.type = "std::optional<" + type + ">";
+                else if (field.occurrence == Occurrence::Repeated)
+                    field.type = "std::vector<" + type + ">";
+                else
+                    field.type = type;
+                result.push_back(field);
+            }
+            // Attributes come first, as in the start tag
+            std::stable_partition(result.begin(), result.end(), [](const Field& field) { return field.member->attribute; });
+            return result;
+        }
+
+        std::string textType(const ElementInfo& info) const
+        {
+            if (info.hasChildren)
+                return std::string();
+            if (!info.declaredType.empty())
+                return info.declaredType;
+            return info.text == Inferred::Unknown ? std::string() : cppType(info.text);
+        }
+
+        static std::string initializer(const std::string& type)
+        {
+            if (type == "bool")
+                return " = false";
+            if (type == "int" || type == "unsigned int" || type == "int64_t" || type == "uint64_t")
+                return " = 0";
+            if (type == "float")
+                return " = 0.0f";
+            if (type == "double")
+                return " = 0.0";
+            return std::string();
+        }
+
+        void emitStruct(const ElementInfo& info, std::ostringstream& definitions, std::ostringstream& functions) const
+        {
+            const std::string& type = m_typeNames.at(info.xmlName);
+            std::vector<Field> all = fields(info);
+            std::vector<const Field*> children;
+            for (const Field& field : all)
+            {
+                if (!field.member->attribute)
+                    children.push_back(&field);
+            }
+            std::string text = textType(info);
+
+            definitions << "struct " << type << "\n{\n"
+                        << "    static constexpr const char* xmlName = " << quoted(info.xmlName) << ";\n\n";
+            for (const Field& field : all)
+                definitions << "    " << field.type << " " << field.name << initializer(field.type) << ";\n";
+            if (!text.empty())
+                definitions << "    " << text << " value" << initializer(text) << ";     // Element text\n";
+            definitions << "\n    bool serialize(tinyxml2::XMLElement* element) const;\n"
+                        << "    bool deserialize(tinyxml2::XMLElement* element);\n"
+                        << "};\n\n";
+
+            // serialize: attributes, text, then children in document order
+            functions << "inline bool " << type << "::serialize(tinyxml2::XMLElement* element) const\n{\n"
+                      << "    if (!element)\n    {\n"
+                      << "        XmlDiagnostics::report(XmlErrorCode::NullElement, nullptr, xmlName, \"Element is null\");\n"
+                      << "        return false;\n    }\n"
+                      << "    bool allSuccess = true;\n";
+            for (const Field& field : all)
+            {
+                if (field.member->attribute)
+                    functions << "    allSuccess &= xmlWriteAttribute(element, " << quoted(field.member->xmlName) << ", " << field.name << ");\n";
+            }
+            if (!text.empty())
+                functions << "    allSuccess &= xmlGeneratedWriteContent(element, value);\n";
+            for (const Field* field : children)
+                functions << "    allSuccess &= xmlGeneratedWrite(element, " << quoted(field->member->xmlName) << ", " << field->name << ");\n";
+            functions << "    return allSuccess;\n}\n\n";
+
+            // deserialize: one pass over the children, matched in the expected order first
+            functions << "inline bool " << type << "::deserialize(tinyxml2::XMLElement* element)\n{\n"
+                      << "    if (!element)\n    {\n"
+                      << "        XmlDiagnostics::report(XmlErrorCode::NullElement, nullptr, xmlName, \"Element is null\");\n"
+                      << "        return false;\n    }\n"
+                      << "    bool allSuccess = true;\n";
+            for (const Field& field : all)
+            {
+                if (field.member->attribute)
+                    functions << "    allSuccess &= xmlReadAttribute(element, " << quoted(field.member->xmlName) << ", " << field.name << ");\n";
+            }
+            if (!text.empty())
+                functions << "    allSuccess &= xmlGeneratedRead(element, value);\n";
+
+            size_t count = children.size();
+            functions << "\n    static const char* const names[] = {";
+            for (size_t index = 0; index < count; ++index)
+                functions << (index ? ", " : " ") << quoted(children[index]->member->xmlName);
+            functions << (count ? " };\n" : " nullptr };\n");
+            // Only required and optional children are checked after the loop
+            bool tracked = std::any_of(children.begin(), children.end(),
+                [](const Field* field) { return field->occurrence != Occurrence::Repeated; });
+            if (tracked)
+                functions << "    bool found[" << count << "] = {};\n";
+            for (const Field* field : children)
+            {
+                if (field->occurrence == Occurrence::Repeated)
+                    functions << "    " << field->name << ".clear();\n";
+            }
+            functions << "    size_t expected = 0;\n"
+                      << "    for (tinyxml2::XMLElement* child = element->FirstChildElement(); child; child = child->NextSiblingElement())\n    {\n"
+                      << "        size_t index = xmlGeneratedMatch(names, " << count << ", child->Name(), expected);\n"
+                      << "        switch (index)\n        {\n";
+            for (size_t index = 0; index < count; ++index)
+            {
+                // Repeated elements expect another item of their own first
+                size_t next = children[index]->occurrence == Occurrence::Repeated ? index : index + 1;
+                functions << "        case " << index << ":\n"
+                          << "            allSuccess &= xmlGeneratedRead(child, " << children[index]->name << ");\n"
+                          << "            expected = " << (next < count ? next : 0) << ";\n"
+                          << "            break;\n";
+            }
+            functions << "        default:\n"
+                      << "            XmlDiagnostics::report(XmlErrorCode::DeserializeFailed, element, child->Name(), \"Unexpected element (ignored)\");\n"
+                      << "            continue;\n"
+                      << "        }\n";
+            if (tracked)
+                functions << "        found[index] = true;\n";
+            functions << "    }\n";
+            for (size_t index = 0; index < count; ++index)
+            {
+                const Field& field = *children[index];
+                if (field.occurrence == Occurrence::Required)
+                {
+                    functions << "    if (!found[" << index << "])\n    {\n"
+                              << "        xmlGeneratedMissing(element, names[" << index << "]);\n"
+                              << "        allSuccess = false;\n    }\n";
+                }
+                else if (field.occurrence == Occurrence::Optional)
+                {
+                    functions << "    if (!found[" << index << "])\n"
+                              << "        " << field.name << ".reset();\n";
+                }
+            }
+            functions << "    return allSuccess;\n}\n\n";
+        }
+    };
+
+    // Leaves the file untouched when the content is the same, so dependent code is not rebuilt
+    bool writeIfChanged(const std::string& filename, const std::string& content)
+    {
+        std::ifstream existing(filename, std::ios::binary);
+        if (existing)
+        {
+            std::ostringstream current;
+            current << existing.rdbuf();
+            if (current.str() == content)
+                return true;
+        }
+        std::ofstream output(filename, std::ios::binary | std::ios::trunc);
+        output << content;
+        output.close();
+        return static_cast<bool>(output);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage();
+        return 2;
+    }
+
+    tinyxml2::XMLDocument document;
+    if (document.LoadFile(options.input.c_str()) != tinyxml2::XML_SUCCESS || !document.RootElement())
+    {
+        std::cerr << options.input << ": " << (document.Error() ? document.ErrorStr() : "no root element") << "\n";
+        return 1;
+    }
+
+    Model model(options.schema);
+    if (!model.collect(document.RootElement()))
+    {
+        std::cerr << options.input << ": " << model.error() << "\n";
+        return 1;
+    }
+
+    Generator generator(model, options);
+    std::string output;
+    if (!generator.generate(document.RootElement()->Name(), output))
+    {
+        std::cerr << options.input << ": " << generator.error() << "\n";
+        return 1;
+    }
+    if (!writeIfChanged(options.output, output))
+    {
+        std::cerr << options.output << ": cannot write file\n";
+        return 1;
+    }
+    return 0;
+}
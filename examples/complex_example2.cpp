@@ -1,8 +1,14 @@
 #include <iostream>
+#include <memory>
 #include <vector>
 #include "tinyxml2.h"
 #include "XmlElementWrapper.h"
 #include "XMLSerializable.h"
+#include "XmlDocumentPool.h"
+#include "XmlMappedFile.h"
+#include "XmlParallel.h"
+#include "XmlRecordReader.h"
+#include "XmlStreamWriter.h"
 
 // This test program defines a set of classes (`Base`, `Platform`, `LocationSet`, `Imput`) that inherit from the
 // `XMLSerializable` base class, enabling XML serialization and deserialization using the TinyXML2 library.
@@ -34,39 +40,49 @@ public:
     bool deserialize(tinyxml2::XMLElement* element) override { return XMLSerializable::deserialize(element); }
 
 protected:
-    void onDeserializeError(const std::string& key, const std::string& reason) const override
+    void onDeserializeError(const std::string& key, const std::string& reason, DeserializeIssue issue) const override
     {
-        if (key == "Code" || key == "ID")
+        // Unexpected and duplicate elements are ignored, so only a critical field that could not be read is fatal
+        if (issue == DeserializeIssue::MissingOrInvalid && (key == "Code" || key == "ID"))
         {
             throw std::runtime_error("Critical field '" + key + "' missing or invalid in Base");
         }
         else
         {
-            std::cerr << "Base: Ignored missing/non-critical field '" << key << "': " << reason << std::endl;
+            std::cerr << "Base: Ignored '" << key << "': " << reason << std::endl;
         }
     }
 };
 
-// Platform class for additional geographic entities
+// Platform class for additional geographic entities. Platforms are numerous, so the field names and
+// types are registered once in a shared layout and each instance only stores its values.
 class Platform : public XMLSerializable
 {
 public:
-    Platform()
-    {
-        addData("Code", std::string("0"));
-        addData("ID", std::string(""));
-        addData("LatitudeDegree", 0);
-        addData("LatitudeMinute", 0);
-        addData("LatitudeSecond", 0.0f);
-        addData("LatitudeCP", std::string("N"));
-        addData("LongitudeDegree", 0);
-        addData("LongitudeMinute", 0);
-        addData("LongitudeSecond", 0.0f);
-        addData("LongitudeCP", std::string("E"));
-    }
+    Platform() : XMLSerializable(layout()) {}
 
     bool serialize(tinyxml2::XMLElement* element) const override { return XMLSerializable::serialize(element); }
     bool deserialize(tinyxml2::XMLElement* element) override { return XMLSerializable::deserialize(element); }
+
+    static const std::shared_ptr<const XmlFieldLayout>& layout()
+    {
+        static const std::shared_ptr<const XmlFieldLayout> shared = []()
+            {
+                auto layout = std::make_shared<XmlFieldLayout>();
+                layout->add("Code", std::string("0"));
+                layout->add("ID", std::string(""));
+                layout->add("LatitudeDegree", 0);
+                layout->add("LatitudeMinute", 0);
+                layout->add("LatitudeSecond", 0.0f);
+                layout->add("LatitudeCP", std::string("N"));
+                layout->add("LongitudeDegree", 0);
+                layout->add("LongitudeMinute", 0);
+                layout->add("LongitudeSecond", 0.0f);
+                layout->add("LongitudeCP", std::string("E"));
+                return layout;
+            }();
+        return shared;
+    }
 };
 
 // LocationSet class to aggregate Base and Platforms
@@ -84,20 +100,26 @@ public:
         bool allSuccess = true;
         tinyxml2::XMLElement* baseSet = element->GetDocument()->NewElement("BaseSet");
         tinyxml2::XMLElement* baseElement = element->GetDocument()->NewElement("Base");
-        Base base = getData<Base>("Base");
-        allSuccess &= base.serialize(baseElement);
+        allSuccess &= getDataRef<Base>("Base").serialize(baseElement);
         baseSet->InsertEndChild(baseElement);
         element->InsertEndChild(baseSet);
 
         tinyxml2::XMLElement* platformSet = element->GetDocument()->NewElement("PlatformSet");
-        std::vector<Platform> platforms = getData<std::vector<Platform>>("Platforms");
-        for (const auto& platform : platforms)
-        {
-            tinyxml2::XMLElement* platformElement = element->GetDocument()->NewElement("Platform");
-            allSuccess &= platform.serialize(platformElement);
-            platformSet->InsertEndChild(platformElement);
-        }
         element->InsertEndChild(platformSet);
+        allSuccess &= XmlParallel::serialize(platformSet, "Platform", getDataRef<std::vector<Platform>>("Platforms"));
+        return allSuccess;
+    }
+
+    // Streams the Platforms directly instead of building the PlatformSet subtree
+    bool serializeStream(XmlStreamWriter& writer) const override
+    {
+        bool allSuccess = writer.openElement("BaseSet");
+        allSuccess &= writer.write("Base", getDataRef<Base>("Base"));
+        allSuccess &= writer.closeElement();
+
+        allSuccess &= writer.openElement("PlatformSet");
+        allSuccess &= XmlParallel::serialize(writer, "Platform", getDataRef<std::vector<Platform>>("Platforms"));
+        allSuccess &= writer.closeElement();
         return allSuccess;
     }
 
@@ -110,31 +132,22 @@ public:
             tinyxml2::XMLElement* baseElement = baseSet->FirstChildElement("Base");
             if (baseElement)
             {
-                Base base = getData<Base>("Base");
-                allSuccess &= base.deserialize(baseElement);
-                addData("Base", base);
+                allSuccess &= getDataRef<Base>("Base").deserialize(baseElement);
             }
         }
 
         tinyxml2::XMLElement* platformSet = element->FirstChildElement("PlatformSet");
         if (platformSet)
         {
-            std::vector<Platform> platforms;
-            for (tinyxml2::XMLElement* platformElement = platformSet->FirstChildElement("Platform");
-                platformElement != nullptr;
-                platformElement = platformElement->NextSiblingElement("Platform"))
-            {
-                Platform platform = getData<Platform>("Platforms", Platform());
-                allSuccess &= platform.deserialize(platformElement);
-                platforms.push_back(platform);
-            }
-            addData("Platforms", platforms);
+            // Deserialize straight into the stored vector; large sets are split across threads
+            std::vector<Platform>& platforms = getDataRef<std::vector<Platform>>("Platforms");
+            allSuccess &= XmlParallel::deserialize(platformSet, "Platform", platforms);
         }
         return allSuccess;
     }
 };
 
-// Top-level Imput class
+// Top-level Imput class. The base class (de)serializes the nested LocationSet in place.
 class Imput : public XMLSerializable
 {
 public:
@@ -143,26 +156,9 @@ public:
         addData("LocationSet", LocationSet());
     }
 
-    bool serialize(tinyxml2::XMLElement* element) const override
-    {
-        tinyxml2::XMLElement* locationSetElement = element->GetDocument()->NewElement("LocationSet");
-        LocationSet locationSet = getData<LocationSet>("LocationSet");
-        bool success = locationSet.serialize(locationSetElement);
-        element->InsertEndChild(locationSetElement);
-        return success;
-    }
-
-    bool deserialize(tinyxml2::XMLElement* element) override
+    bool serializeStream(XmlStreamWriter& writer) const override
     {
-        tinyxml2::XMLElement* locationSetElement = element->FirstChildElement("LocationSet");
-        if (locationSetElement)
-        {
-            LocationSet locationSet = getData<LocationSet>("LocationSet");
-            bool success = locationSet.deserialize(locationSetElement);
-            addData("LocationSet", locationSet);
-            return success;
-        }
-        return false;  // No LocationSet found
+        return writer.write("LocationSet", getDataRef<LocationSet>("LocationSet"));
     }
 };
 
@@ -188,17 +184,52 @@ bool loadFromFile(const std::string& filename, Imput& imput)
 
 bool saveToFile(const std::string& filename, const Imput& imput)
 {
-    tinyxml2::XMLDocument doc;
-    tinyxml2::XMLElement* root = doc.NewElement("Imput");
-    bool success = imput.serialize(root);
-    doc.InsertEndChild(root);
+    // Documents of the thread's pool are reused across saves
+    return XmlDocumentPool::local().serializeFile(filename, "Imput", imput);
+}
 
-    if (doc.SaveFile(filename.c_str()) != tinyxml2::XML_SUCCESS)
+bool saveToStream(const std::string& filename, const Imput& imput)
+{
+    XmlStreamWriter writer(filename);
+    if (!writer.isOpen())
     {
-        std::cerr << "Error: Failed to save file " << filename << std::endl;
         return false;
     }
-    return success;
+    bool success = writer.write("Imput", imput);
+    return writer.close() && success;
+}
+
+// Binds the document lazily; LocationSet reads its element itself, so it is loaded in full when
+// first accessed
+size_t countPlatformsLazily(const std::string& filename)
+{
+    tinyxml2::XMLDocument doc;
+    if (doc.LoadFile(filename.c_str()) != tinyxml2::XML_SUCCESS)
+    {
+        return 0;
+    }
+    Imput imput;
+    if (!imput.deserializeLazy(doc.FirstChildElement("Imput")))
+    {
+        return 0;
+    }
+    return imput.getDataRef<LocationSet>("LocationSet").getDataRef<std::vector<Platform>>("Platforms").size();
+}
+
+// Streams the platforms one record at a time from the memory-mapped file, without loading the
+// whole document or copying the file
+size_t streamPlatforms(const std::string& filename)
+{
+    XmlMappedFile file(filename);
+    XmlRecordReader reader(file, "Imput/LocationSet/PlatformSet/Platform");
+    static const XmlSlot<std::string> id = Platform::layout()->slot<std::string>("ID");
+    size_t count = reader.forEach<Platform>([&reader](const Platform& platform)
+        {
+            std::cout << "Streamed Platform ID: " << platform.getDataRef(id) << (reader.lastRecordValid() ? "" : " (invalid)") << std::endl;
+        });
+    if (reader.invalidCount() > 0)
+        std::cerr << reader.invalidCount() << " streamed platforms were invalid" << std::endl;
+    return count;
 }
 
 // Main function
@@ -211,9 +242,9 @@ int main()
         if (loadFromFile("complex_example2_input.xml", imput))
         {
             std::cout << "Loaded successfully!" << std::endl;
-            LocationSet locationSet = imput.getData<LocationSet>("LocationSet");
-            Base base = locationSet.getData<Base>("Base");
-            std::vector<Platform> platforms = locationSet.getData<std::vector<Platform>>("Platforms");
+            const LocationSet& locationSet = imput.getDataRef<LocationSet>("LocationSet");
+            const Base& base = locationSet.getDataRef<Base>("Base");
+            const std::vector<Platform>& platforms = locationSet.getDataRef<std::vector<Platform>>("Platforms");
 
             std::cout << "Base Code: " << base.getData<std::string>("Code") << std::endl;
             std::cout << "Base ID: " << base.getData<std::string>("ID") << std::endl;
@@ -223,6 +254,18 @@ int main()
                     << ", ID: " << platform.getData<std::string>("ID") << std::endl;
             }
 
+            // Test lazy deserialize
+            size_t lazyPlatforms = countPlatformsLazily("complex_example2_input.xml");
+            std::cout << "Lazily loaded " << lazyPlatforms << " platforms" << std::endl;
+            if (lazyPlatforms != platforms.size())
+            {
+                std::cout << "Lazy load mismatch: expected " << platforms.size() << " platforms" << std::endl;
+            }
+
+            // Test streaming
+            size_t streamed = streamPlatforms("complex_example2_input.xml");
+            std::cout << "Streamed " << streamed << " platforms" << std::endl;
+
             // Test serialize
             if (saveToFile("complex_example2_output.xml", imput))
             {
@@ -232,6 +275,16 @@ int main()
             {
                 std::cout << "Save failed" << std::endl;
             }
+
+            // Test streaming serialize
+            if (saveToStream("complex_example2_stream_output.xml", imput))
+            {
+                std::cout << "Streamed successfully to complex_example2_stream_output.xml!" << std::endl;
+            }
+            else
+            {
+                std::cout << "Save failed" << std::endl;
+            }
         }
         else
         {
@@ -1,52 +1,327 @@
 #pragma once
-#include <any>
-#include <map>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include "tinyxml2.h"
+#include "XmlDiagnostics.h"
 #include "XmlElementWrapper.h"
+#include "XmlFieldLayout.h"
+#include "XmlValueTraits.h"
+
+class XmlStreamWriter;
 
 class XMLSerializable
 {
 public:
+    XMLSerializable() = default;
+    // Uses a layout shared by all instances of a class; values start as the layout's defaults
+    explicit XMLSerializable(std::shared_ptr<const XmlFieldLayout> layout);
+    virtual ~XMLSerializable() = default;
+
+    // A copy is not in sync with any element: all of its fields are dirty and it is not bound
+    XMLSerializable(const XMLSerializable& other);
+    XMLSerializable& operator=(const XMLSerializable& other);
+    XMLSerializable(XMLSerializable&& other) = default;
+    XMLSerializable& operator=(XMLSerializable&& other) = default;
+
     virtual bool serialize(tinyxml2::XMLElement* element) const;
     virtual bool deserialize(tinyxml2::XMLElement* element);
 
+    // Lazy alternative to deserialize(): binds the object to element and reads each field only
+    // when it is first accessed through getData/getDataRef/getDataPtr, then keeps the value.
+    // Nested objects are bound lazily too, except those whose class overrides deserialize(), which
+    // are read in full when first accessed. The document must outlive the object until
+    // materialize() reads the remaining fields and detaches it; serialize(), update(),
+    // writeSnapshot() and copies read what they need on their own. Unexpected and duplicate
+    // elements are not reported, and missing fields only when accessed. Lazy objects are not safe
+    // for concurrent readers, since reading a field fills it in.
+    bool deserializeLazy(tinyxml2::XMLElement* element);
+    bool materialize();
+    bool isMaterialized() const;
+
+    // Writes the content of this object into the element currently open in writer. The default
+    // builds it through serialize(tinyxml2::XMLElement*) in the writer's scratch document, so
+    // existing subclasses stream unchanged; override to write directly.
+    virtual bool serializeStream(XmlStreamWriter& writer) const;
+
+    // Binary snapshot of the stored values (see XmlSnapshotCache.h). The default writes the layout
+    // signature and each value in key order, and fails to read data written for another layout;
+    // subclasses that keep state outside the stored values override both.
+    virtual bool writeSnapshot(XmlSnapshotWriter& writer) const;
+    virtual bool readSnapshot(XmlSnapshotReader& reader);
+
+    // Change tracking. Fields become dirty when set through addData/emplaceData or accessed through
+    // the non-const getDataRef/getDataPtr; deserialize() and update() mark them clean. A new object
+    // has all fields dirty.
+    //
+    //     settings.deserialize(root);
+    //     settings.bind(root);
+    //     settings.addData("Volume", 7);
+    //     settings.update();              // Rewrites only <Volume>
+    //     document.SaveFile(path);
+    //
+    // update() rewrites the dirty fields inside element's existing children: scalar text is
+    // replaced in place, nested objects update their own dirty fields, and containers have their
+    // element's content rebuilt. Nested objects whose class overrides serialize() but not update()
+    // are rebuilt through serialize(). Missing children are created and empty optionals removed.
+    // Subclasses that keep state outside the stored values override it.
+    virtual bool update(tinyxml2::XMLElement* element);
+    // Updates the bound element; reports InvalidState if there is none
+    bool update();
+
+    // Element update() writes to by default. The object does not own it; the binding must be
+    // cleared or replaced before the document is destroyed.
+    void bind(tinyxml2::XMLElement* element);
+    tinyxml2::XMLElement* boundElement() const;
+
+    bool isDirty() const;
+    bool isDirty(const std::string& key) const;
+    // For changes made through references kept from getDataRef
+    void markDirty(const std::string& key);
+    void markClean();
+
+    // Stores value under key. A key that is new, or stored with another type, gives this instance
+    // its own copy of the layout.
     template <typename T>
     void addData(const std::string& key, const T& value)
     {
-        m_data[key] = value;
+        size_t slot = m_layout ? m_layout->slot<T>(key).index : XmlFieldLayout::npos;
+        if (slot == XmlFieldLayout::npos)
+            slot = mutableLayout().add(key, value).index;
+        assign(slot, value);
     }
 
+    // Adds a container (std::vector, std::map or std::optional) stored under a differently named
+    // element, for example addData("Platforms", std::vector<Platform>(), { "PlatformSet", "Platform" })
     template <typename T>
-    T getData(const std::string& key) const
+    void addData(const std::string& key, const T& value, const XmlContainerNames& names)
     {
-        return std::any_cast<T>(m_data.at(key));
+        size_t slot = m_layout ? m_layout->slot<T>(key).index : XmlFieldLayout::npos;
+        if (slot == XmlFieldLayout::npos || m_layout->field(slot).element != names.container || m_layout->field(slot).item != names.item)
+            slot = mutableLayout().add(key, value, names).index;
+        assign(slot, value);
     }
 
+    // Stores a scalar or optional scalar under key as an attribute of the object's element
     template <typename T>
-    T getData(const std::string& key, const T& defaultValue) const
+    void addAttribute(const std::string& key, const T& value)
     {
-        try
-        {
-            return std::any_cast<T>(m_data.at(key));
-        }
-        catch (const std::bad_any_cast&)
+        size_t slot = m_layout ? m_layout->slot<T>(key).index : XmlFieldLayout::npos;
+        if (slot == XmlFieldLayout::npos || !m_layout->field(slot).attribute)
+            slot = mutableLayout().addAttribute(key, value).index;
+        assign(slot, value);
+    }
+
+    // Fast path for a field of the layout
+    template <typename T>
+    void addData(XmlSlot<T> slot, const T& value)
+    {
+        forget(slot.index);
+        T& stored = checkedValue<T>(slot.index);
+        touch(slot.index);
+        stored = value;
+    }
+
+    // Constructs (or moves) the value in place and returns a reference to it. A new key requires T
+    // to be default constructible.
+    template <typename T, typename... Args>
+    T& emplaceData(const std::string& key, Args&&... args)
+    {
+        size_t slot = m_layout ? m_layout->slot<T>(key).index : XmlFieldLayout::npos;
+        if (slot == XmlFieldLayout::npos)
         {
-            return defaultValue;
+            slot = mutableLayout().add(key, T()).index;
+            m_values.resize(m_layout->size());
         }
+        forget(slot);
+        touch(slot);
+        return m_values[slot].emplace<T>(std::forward<Args>(args)...);
+    }
+
+    // Copy of the stored value; throws std::out_of_range if the key is missing. A value of another
+    // type is reported as TypeMismatch and T() is returned.
+    template <typename T>
+    T getData(const std::string& key) const
+    {
+        size_t slot = checkedSlot(key);
+        load(slot);
+        if (const T* value = m_values[slot].get<T>())
+            return *value;
+        reportTypeMismatch(slot);
+        return T();
+    }
+
+    template <typename T>
+    T getData(const std::string& key, const T& defaultValue) const
+    {
+        const T* value = getDataPtr<T>(key);
+        return value ? *value : defaultValue;
+    }
+
+    template <typename T>
+    T getData(XmlSlot<T> slot) const
+    {
+        return getDataRef(slot);
+    }
+
+    // Access to the stored value without copying; throws std::out_of_range if the key is missing
+    // or holds another type (the latter is also reported as TypeMismatch)
+    template <typename T>
+    T& getDataRef(const std::string& key)
+    {
+        size_t slot = checkedSlot(key);
+        load(slot);
+        T& value = checkedValue<T>(slot);
+        touch(slot);
+        return value;
+    }
+
+    template <typename T>
+    const T& getDataRef(const std::string& key) const
+    {
+        size_t slot = checkedSlot(key);
+        load(slot);
+        return checkedValue<T>(slot);
     }
 
+    template <typename T>
+    T& getDataRef(XmlSlot<T> slot)
+    {
+        load(slot.index);
+        T& value = checkedValue<T>(slot.index);
+        touch(slot.index);
+        return value;
+    }
+
+    template <typename T>
+    const T& getDataRef(XmlSlot<T> slot) const
+    {
+        load(slot.index);
+        return checkedValue<T>(slot.index);
+    }
+
+    // Pointer to the stored value, or nullptr if the key is missing or holds another type
+    template <typename T>
+    T* getDataPtr(const std::string& key)
+    {
+        size_t slot = m_layout ? m_layout->find(key) : XmlFieldLayout::npos;
+        if (slot == XmlFieldLayout::npos)
+            return nullptr;
+        load(slot);
+        T* value = m_values[slot].get<T>();
+        if (value)
+            touch(slot);
+        return value;
+    }
+
+    template <typename T>
+    const T* getDataPtr(const std::string& key) const
+    {
+        size_t slot = m_layout ? m_layout->find(key) : XmlFieldLayout::npos;
+        if (slot == XmlFieldLayout::npos)
+            return nullptr;
+        load(slot);
+        return m_values[slot].get<T>();
+    }
+
+    // Layout of this instance; nullptr while no data has been added
+    const std::shared_ptr<const XmlFieldLayout>& layout() const;
+
 protected:
-    std::map<std::string, std::any> m_data;
+    // Replace the m_data map of 1.0.0. Implementation details: subclasses should go through
+    // addData/getData/getDataRef and layout() instead.
+    // Field names and types, shared between instances until one of them adds a field
+    std::shared_ptr<const XmlFieldLayout> m_layout;
+    // Values indexed by layout slot. Mutable because const accessors fill in lazily read fields.
+    mutable std::vector<XmlValue> m_values;
+
+    // What onDeserializeError is reporting
+    enum class DeserializeIssue
+    {
+        MissingOrInvalid,   // Field could not be read and keeps its default value; key is the field key
+        Unexpected,         // Child element matches no field and is ignored; key is the element name
+        Duplicate           // Repeated element of a field already read, ignored; key is the element name
+    };
 
-    virtual void onDeserializeError(const std::string& key, const std::string& reason) const
+    // Default error hooks forward to the diagnostics sink (see XmlDiagnostics.h)
+    virtual void onDeserializeError(const std::string& key, const std::string& reason, DeserializeIssue /*issue*/) const
     {
-        std::cerr << "Deserialize error for '" << key << "': " << reason << " (using default value)" << std::endl;
+        XmlDiagnostics::report(XmlErrorCode::DeserializeFailed, nullptr, key.c_str(), reason.c_str());
     }
 
     virtual void onSerializeError(const std::string& key, const std::string& reason) const
     {
-        std::cerr << "Serialize error for '" << key << "': " << reason << std::endl;
+        XmlDiagnostics::report(XmlErrorCode::SerializeFailed, nullptr, key.c_str(), reason.c_str());
+    }
+
+private:
+    // Whether m_layout was created by this instance, and so may be modified while not shared
+    bool m_ownsLayout = false;
+    // Dirty flags by slot; m_allDirty stands for every field, so new objects need no flags
+    bool m_allDirty = true;
+    std::vector<bool> m_dirty;
+    tinyxml2::XMLElement* m_boundElement = nullptr;
+    // Lazy mode: element the fields flagged in m_pending are still to be read from. The flags are
+    // dropped once every field has been read.
+    tinyxml2::XMLElement* m_source = nullptr;
+    mutable std::vector<bool> m_pending;
+    mutable size_t m_pendingCount = 0;
+
+    XmlFieldLayout& mutableLayout();
+    size_t checkedSlot(const std::string& key) const;
+    void reportTypeMismatch(size_t slot) const;
+
+    template <typename T>
+    T& checkedValue(size_t slot) const
+    {
+        T* value = m_values.at(slot).get<T>();
+        if (!value)
+        {
+            reportTypeMismatch(slot);
+            throw std::out_of_range("XMLSerializable: key '" + m_layout->field(slot).key + "' holds another type");
+        }
+        return *value;
+    }
+
+    void load(size_t slot) const
+    {
+        if (!m_pending.empty() && slot < m_pending.size() && m_pending[slot])
+            loadPending(slot);
+    }
+
+    // The value is being replaced, so it need not be read
+    void forget(size_t slot)
+    {
+        if (!m_pending.empty() && slot < m_pending.size() && m_pending[slot])
+            clearPending(slot);
+    }
+
+    bool loadPending(size_t slot) const;
+    bool readAttribute(tinyxml2::XMLElement* element, size_t slot) const;
+    bool loadAll() const;
+    void clearPending(size_t slot) const;
+
+    void touch(size_t slot)
+    {
+        if (m_allDirty)
+            return;
+        if (slot >= m_dirty.size())
+            m_dirty.resize(slot + 1, false);
+        m_dirty[slot] = true;
+    }
+
+    template <typename T>
+    void assign(size_t slot, const T& value)
+    {
+        if (slot >= m_values.size())
+            m_values.resize(m_layout->size());
+        // Assigning to the stored T reuses its storage (string or vector capacity)
+        m_values[slot].assign(value);
+        forget(slot);
+        touch(slot);
     }
 };
 
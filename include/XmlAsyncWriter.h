@@ -0,0 +1,83 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class XMLSerializable;
+class XmlDiagnosticSink;
+
+// Writes data to filename through a temporary file in the same directory that is flushed to disk
+// and then renamed over filename, so after a crash filename holds either the old or the new
+// content, never a truncated mix. Failures are reported as IoFailed.
+bool xmlWriteFileAtomic(const std::string& filename, const char* data, size_t size);
+
+// Saves documents on a background thread. save() formats the object on the calling thread, so
+// the object may change as soon as it returns, and hands the bytes to the writer thread, which
+// stores them with xmlWriteFileAtomic():
+//
+//     XmlAsyncWriter& writer = XmlAsyncWriter::shared();
+//     std::future<bool> saved = writer.save("state.xml", "Imput", imput);
+//     ...
+//     writer.save("state.xml", "Imput", imput, [](bool success) { /* on the writer thread */ });
+//
+// A save of a file that is still waiting for the writer replaces the waiting content, so only the
+// latest state is written; the completions of both saves report the result of that one write.
+// Write errors are reported on the writer thread, to the sink given at construction or the
+// console sink. Callbacks run on the writer thread and must not throw.
+class XmlAsyncWriter
+{
+public:
+    using Callback = std::function<void(bool success)>;
+
+    explicit XmlAsyncWriter(XmlDiagnosticSink* sink = nullptr);
+    // Finishes the saves already queued
+    ~XmlAsyncWriter();
+
+    XmlAsyncWriter(const XmlAsyncWriter&) = delete;
+    XmlAsyncWriter& operator=(const XmlAsyncWriter&) = delete;
+
+    // Serializes object as a rootName document and queues it. If serialization fails nothing is
+    // queued and the save completes with false at once, on the calling thread; otherwise the
+    // result is that of the write.
+    std::future<bool> save(const std::string& filename, const char* rootName, const XMLSerializable& object, bool compact = false);
+    void save(const std::string& filename, const char* rootName, const XMLSerializable& object, Callback callback, bool compact = false);
+
+    // Queues already formatted content
+    std::future<bool> save(const std::string& filename, std::string content);
+    void save(const std::string& filename, std::string content, Callback callback);
+
+    // Waits until every save queued so far has been written
+    void flush();
+    // Writes queued or in progress
+    size_t pending() const;
+
+    // Process-wide writer, created on first use
+    static XmlAsyncWriter& shared();
+
+private:
+    struct Job
+    {
+        std::string content;
+        std::vector<Callback> callbacks;    // One per coalesced save
+    };
+
+    XmlDiagnosticSink* m_sink;
+    std::map<std::string, Job> m_jobs;      // Waiting saves by filename
+    std::deque<std::string> m_order;        // Filenames of m_jobs in queue order
+    size_t m_pending;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    bool m_stop;
+    std::thread m_thread;
+
+    void enqueue(const std::string& filename, std::string content, Callback callback);
+    void work();
+};
@@ -0,0 +1,283 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "tinyxml2.h"
+#include "XmlDiagnostics.h"
+#include "XmlDocumentPool.h"
+#include "XmlThreadPool.h"
+#include "XmlValueTraits.h"
+
+// Reads filename into content, replacing it. Failures are reported as IoFailed.
+bool xmlReadFile(const std::string& filename, std::string& content);
+
+// One file of a batch as delivered to the consumer
+template <typename T>
+struct XmlBatchItem
+{
+    size_t index = 0;                       // Position in the file list
+    const std::string* filename = nullptr;
+    T object{};
+    bool success = false;                   // Read, parsed and deserialized without errors
+    std::vector<XmlDiagnostic> diagnostics; // Reported while processing this file
+};
+
+struct XmlBatchOptions
+{
+    size_t readers = 2;         // Threads reading files
+    size_t capacity = 0;        // Files read but not yet consumed; 0 uses 4 per pool thread
+    bool ordered = false;       // Deliver in file list order instead of completion order
+};
+
+// Loads many small documents through a pipeline: reader threads load the files, the thread pool
+// parses and deserializes them into T, and the consumer runs on the calling thread:
+//
+//     std::vector<std::string> files = ...;
+//     XmlBatch::load<Imput>(files, "Imput", [](XmlBatchItem<Imput>& item)
+//         {
+//             if (item.success)
+//                 store(std::move(item.object));
+//         });
+//
+// At most options.capacity files are between reading and consumption, so a slow consumer holds
+// back the readers instead of filling memory. Each file's diagnostics are collected into its item
+// and replayed to the caller's sink before the consumer sees it. The calling thread decodes files
+// itself while it waits, so a busy or empty pool slows the batch down but cannot stall it. An
+// exception thrown while decoding a file fails that file's item with a DeserializeFailed
+// diagnostic. If the consumer throws, the remaining files are skipped and the exception is
+// rethrown.
+class XmlBatch
+{
+public:
+    // Returns true if every file was loaded successfully
+    template <typename T, typename Consumer>
+    static bool load(const std::vector<std::string>& filenames, const char* rootName, Consumer&& consumer,
+        const XmlBatchOptions& options = XmlBatchOptions(), XmlThreadPool& pool = XmlThreadPool::shared())
+    {
+        static_assert(XmlValueTraits<T>::supported, "Type is not supported for XML deserialization");
+        auto state = std::make_shared<State<T>>();
+        state->filenames = &filenames;
+        state->rootName = rootName;
+        state->capacity = options.capacity ? options.capacity : 4 * pool.concurrency();
+        state->pool = &pool;
+
+        std::vector<std::thread> readers;
+        size_t readerCount = std::min(std::max<size_t>(options.readers, 1), filenames.size());
+        for (size_t i = 0; i < readerCount; ++i)
+            readers.emplace_back([state]() { state->read(); });
+
+        bool allSuccess = true;
+        std::exception_ptr error;
+        try
+        {
+            for (size_t delivered = 0; delivered < filenames.size(); ++delivered)
+            {
+                std::unique_ptr<XmlBatchItem<T>> item = state->next(options.ordered ? delivered : NoIndex);
+                for (const XmlDiagnostic& diagnostic : item->diagnostics)
+                    XmlDiagnostics::sink().report(diagnostic);
+                allSuccess &= item->success;
+                consumer(*item);
+            }
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+            state->abort();
+        }
+        for (std::thread& reader : readers)
+            reader.join();
+        if (error)
+            std::rethrow_exception(error);
+        return allSuccess;
+    }
+
+private:
+    static constexpr size_t NoIndex = static_cast<size_t>(-1);
+
+    struct Loaded
+    {
+        size_t index = 0;
+        std::string content;
+        bool success = false;
+        std::vector<XmlDiagnostic> diagnostics;
+    };
+
+    // Collects the diagnostics reported by the calling thread for the lifetime of the scope
+    class Collector
+    {
+    public:
+        explicit Collector(std::vector<XmlDiagnostic>& target) : m_target(target), m_scope(m_sink) {}
+        ~Collector()
+        {
+            m_target.insert(m_target.end(), m_sink.diagnostics().begin(), m_sink.diagnostics().end());
+        }
+
+    private:
+        std::vector<XmlDiagnostic>& m_target;
+        XmlCollectingSink m_sink;
+        XmlScopedSink m_scope;
+    };
+
+    // Shared with the reader threads and the decode jobs posted to the pool, which may only get to
+    // run after load() has returned; they then find nothing to do.
+    template <typename T>
+    struct State : std::enable_shared_from_this<State<T>>
+    {
+        const std::vector<std::string>* filenames = nullptr;
+        std::string rootName;
+        size_t capacity = 0;
+        XmlThreadPool* pool = nullptr;
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        size_t nextRead = 0;
+        size_t inFlight = 0;        // Files being read, waiting, decoding or decoded
+        size_t decoding = 0;
+        bool stopped = false;
+        std::deque<Loaded> loaded;  // Waiting to be decoded
+        std::vector<std::unique_ptr<XmlBatchItem<T>>> decoded;
+
+        void read()
+        {
+            for (;;)
+            {
+                Loaded file;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [this]() { return stopped || nextRead == filenames->size() || inFlight < capacity; });
+                    if (stopped || nextRead == filenames->size())
+                        return;
+                    file.index = nextRead++;
+                    ++inFlight;
+                }
+                {
+                    Collector collector(file.diagnostics);
+                    file.success = xmlReadFile((*filenames)[file.index], file.content);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    loaded.push_back(std::move(file));
+                }
+                changed.notify_all();
+                // The job holds its own reference, since it may outlive the batch
+                std::shared_ptr<State> self = this->shared_from_this();
+                pool->post([self]() { self->decodeOne(); });
+            }
+        }
+
+        // Decodes the oldest loaded file, if any; false if there was none
+        bool decodeOne()
+        {
+            Loaded file;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stopped || loaded.empty())
+                    return false;
+                file = std::move(loaded.front());
+                loaded.pop_front();
+                ++decoding;
+            }
+
+            auto item = std::make_unique<XmlBatchItem<T>>();
+            item->index = file.index;
+            item->filename = &(*filenames)[file.index];
+            item->diagnostics = std::move(file.diagnostics);
+            if (file.success)
+            {
+                // An exception fails this file only; it must not escape a pool job or leave the
+                // file counted as decoding
+                Collector collector(item->diagnostics);
+                try
+                {
+                    item->success = decode(*item, file.content);
+                }
+                catch (const std::exception& error)
+                {
+                    item->success = false;
+                    XmlDiagnostics::report(XmlErrorCode::DeserializeFailed, nullptr, item->filename->c_str(), error.what());
+                }
+                catch (...)
+                {
+                    item->success = false;
+                    XmlDiagnostics::report(XmlErrorCode::DeserializeFailed, nullptr, item->filename->c_str(), "Exception while decoding file");
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                decoded.push_back(std::move(item));
+                --decoding;
+            }
+            changed.notify_all();
+            return true;
+        }
+
+        bool decode(XmlBatchItem<T>& item, const std::string& content)
+        {
+            XmlPooledDocument document = XmlDocumentPool::local().acquire();
+            if (content.empty() || document->Parse(content.data(), content.size()) != tinyxml2::XML_SUCCESS)
+            {
+                XmlDiagnostics::report(XmlErrorCode::ParseFailed, nullptr, item.filename->c_str(),
+                    content.empty() ? "Document is empty" : document->ErrorStr());
+                return false;
+            }
+            tinyxml2::XMLElement* root = document->RootElement();
+            if (!root || std::strcmp(root->Name(), rootName.c_str()) != 0)
+            {
+                XmlDiagnostics::report(XmlErrorCode::ElementNotFound, nullptr, rootName.c_str(), "Root element not found");
+                return false;
+            }
+            return XmlValueTraits<T>::read(root, item.object, rootName.c_str());
+        }
+
+        // Next decoded item (the one for file index, unless NoIndex), decoding on the calling
+        // thread while none is ready
+        std::unique_ptr<XmlBatchItem<T>> next(size_t index)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            for (;;)
+            {
+                auto found = std::find_if(decoded.begin(), decoded.end(), [index](const std::unique_ptr<XmlBatchItem<T>>& item)
+                    {
+                        return index == NoIndex || item->index == index;
+                    });
+                if (found != decoded.end())
+                {
+                    std::unique_ptr<XmlBatchItem<T>> item = std::move(*found);
+                    decoded.erase(found);
+                    --inFlight;
+                    lock.unlock();
+                    changed.notify_all();
+                    return item;
+                }
+                if (!loaded.empty())
+                {
+                    lock.unlock();
+                    decodeOne();
+                    lock.lock();
+                    continue;
+                }
+                changed.wait(lock);
+            }
+        }
+
+        // Stops reading and decoding, and waits for the files being decoded, which refer to the
+        // caller's file list
+        void abort()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            stopped = true;
+            loaded.clear();
+            changed.notify_all();
+            changed.wait(lock, [this]() { return decoding == 0; });
+        }
+    };
+};
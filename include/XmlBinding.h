@@ -0,0 +1,95 @@
+#pragma once
+#include <tuple>
+#include "tinyxml2.h"
+#include "XmlDiagnostics.h"
+#include "XmlValueTraits.h"
+#include "XMLSerializable.h"
+
+// Compile-time field binding for plain structs.
+//
+// A struct lists its fields once as (element name, member pointer) pairs:
+//
+//     struct Point
+//     {
+//         int x = 0;
+//         double y = 0.0;
+//         XML_FIELDS(XML_FIELD(Point, x), xmlField("Y", &Point::y))
+//     };
+//
+// Scalar and optional scalar members can be bound to attributes of the struct's element instead,
+// with xmlAttribute("name", &Class::member) or XML_ATTRIBUTE(Class, member).
+//
+// XmlBinding then generates serialize/deserialize code specialized for that struct on top of the
+// XmlElementWrapper operators, without the std::map/std::any storage used by XMLSerializable.
+// Bound fields may be any type supported by XmlValueTraits, including containers.
+
+template <typename Class, typename Member>
+struct XmlField
+{
+    static constexpr bool attribute = false;
+
+    const char* name;
+    Member Class::* member;
+};
+
+template <typename Class, typename Member>
+struct XmlAttributeField
+{
+    static_assert(XmlIsAttributeValue<Member>::value, "Only scalars and optional scalars can be bound to attributes");
+    static constexpr bool attribute = true;
+
+    const char* name;
+    Member Class::* member;
+};
+
+template <typename Class, typename Member>
+constexpr XmlField<Class, Member> xmlField(const char* name, Member Class::* member)
+{
+    return XmlField<Class, Member>{ name, member };
+}
+
+template <typename Class, typename Member>
+constexpr XmlAttributeField<Class, Member> xmlAttribute(const char* name, Member Class::* member)
+{
+    return XmlAttributeField<Class, Member>{ name, member };
+}
+
+// Binds a member under an element of the same name
+#define XML_FIELD(Class, member) xmlField(#member, &Class::member)
+// Binds a member to an attribute of the same name
+#define XML_ATTRIBUTE(Class, member) xmlAttribute(#member, &Class::member)
+
+// Declares the bound field list of a struct; use inside the struct body
+#define XML_FIELDS(...) \
+    static constexpr auto xmlFields() { return std::make_tuple(__VA_ARGS__); }
+
+class XmlBinding
+{
+public:
+    template <typename T>
+    static bool serialize(tinyxml2::XMLElement* element, const T& object)
+    {
+        static_assert(XmlHasFields<T>::value, "Type has no XML_FIELDS declaration");
+        if (!element)
+        {
+            XmlDiagnostics::report(XmlErrorCode::NullElement, nullptr, nullptr, "Element is null");
+            return false;
+        }
+        return XmlValueTraits<T>::write(element, object, XmlDefaultItemName);
+    }
+
+    template <typename T>
+    static bool deserialize(tinyxml2::XMLElement* element, T& object)
+    {
+        static_assert(XmlHasFields<T>::value, "Type has no XML_FIELDS declaration");
+        if (!element)
+        {
+            XmlDiagnostics::report(XmlErrorCode::NullElement, nullptr, nullptr, "Element is null");
+            return false;
+        }
+        return XmlValueTraits<T>::read(element, object, XmlDefaultItemName);
+    }
+};
+
+// The free serialize/deserialize(element, name, value) helpers for bound structs are provided by
+// XmlValueTraits.h
@@ -0,0 +1,127 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "tinyxml2.h"
+
+// Error reporting for the library. Problems are described by an error code, the path of the
+// element they occurred under and the key (child element or field name) involved, and are
+// delivered to a pluggable sink instead of being written to std::cerr.
+//
+// Diagnostics can be switched off at runtime with XmlDiagnostics::setEnabled(false), or compiled
+// out entirely by defining TINYXMLHELPER_DISABLE_DIAGNOSTICS (CMake option TINYXMLHELPER_DIAGNOSTICS).
+
+enum class XmlErrorCode
+{
+    NullElement,        // Operation on an element that does not exist
+    ElementNotFound,    // Named child element is missing
+    MissingText,        // Element has no text content
+    ConversionFailed,   // Text could not be converted to the requested type
+    FormatFailed,       // Value could not be formatted as text
+    DeserializeFailed,  // Reported by XMLSerializable::onDeserializeError (see XMLSerializable::DeserializeIssue)
+    SerializeFailed,    // Reported by XMLSerializable::onSerializeError
+    ParseFailed,        // Document or record is not well-formed XML
+    IoFailed,           // File could not be opened, read or written
+    InvalidState,       // API used out of order
+    TypeMismatch        // Stored value has another type than the one requested
+};
+
+const char* toString(XmlErrorCode code);
+
+struct XmlDiagnostic
+{
+    XmlErrorCode code;
+    std::string path;       // Slash-separated path of the element the key was looked up under
+    std::string key;
+    std::string message;
+};
+
+class XmlDiagnosticSink
+{
+public:
+    virtual ~XmlDiagnosticSink() = default;
+    virtual void report(const XmlDiagnostic& diagnostic) = 0;
+};
+
+// Default sink: one line per diagnostic on stderr, without flushing
+class XmlConsoleSink : public XmlDiagnosticSink
+{
+public:
+    void report(const XmlDiagnostic& diagnostic) override;
+};
+
+// Keeps diagnostics in memory for later inspection
+class XmlCollectingSink : public XmlDiagnosticSink
+{
+public:
+    void report(const XmlDiagnostic& diagnostic) override;
+
+    const std::vector<XmlDiagnostic>& diagnostics() const;
+    bool empty() const;
+    void clear();
+
+private:
+    std::vector<XmlDiagnostic> m_diagnostics;
+};
+
+class XmlDiagnostics
+{
+public:
+    // Sink used by the calling thread; nullptr restores the console sink
+    static void setSink(XmlDiagnosticSink* sink);
+    static XmlDiagnosticSink& sink();
+
+    // Process-wide switch; reporting is a single flag test while disabled
+    static void setEnabled(bool enabled);
+
+#ifdef TINYXMLHELPER_DISABLE_DIAGNOSTICS
+    static constexpr bool enabled() { return false; }
+    static void report(XmlErrorCode, const tinyxml2::XMLNode*, const char*, const char*) {}
+#else
+    static bool enabled();
+
+    // Reports a problem with key under element. A null element stands for the element currently
+    // being processed by an enclosing XmlDiagnosticScope.
+    static void report(XmlErrorCode code, const tinyxml2::XMLNode* element, const char* key, const char* message)
+    {
+        if (enabled())
+            dispatch(code, element, key, message);
+    }
+#endif
+
+    // Slash-separated element names from the document root down to node
+    static std::string path(const tinyxml2::XMLNode* node);
+
+private:
+    static void dispatch(XmlErrorCode code, const tinyxml2::XMLNode* element, const char* key, const char* message);
+};
+
+// Installs a sink for the calling thread for the lifetime of the scope
+class XmlScopedSink
+{
+public:
+    explicit XmlScopedSink(XmlDiagnosticSink& sink);
+    ~XmlScopedSink();
+
+    XmlScopedSink(const XmlScopedSink&) = delete;
+    XmlScopedSink& operator=(const XmlScopedSink&) = delete;
+
+private:
+    XmlDiagnosticSink* m_previous;
+};
+
+// Marks the element being processed, so reports without an element (such as the
+// XMLSerializable error hooks) still carry a path
+class XmlDiagnosticScope
+{
+public:
+    explicit XmlDiagnosticScope(const tinyxml2::XMLNode* element);
+    ~XmlDiagnosticScope();
+
+    XmlDiagnosticScope(const XmlDiagnosticScope&) = delete;
+    XmlDiagnosticScope& operator=(const XmlDiagnosticScope&) = delete;
+
+    static const tinyxml2::XMLNode* current();
+
+private:
+    const tinyxml2::XMLNode* m_previous;
+};
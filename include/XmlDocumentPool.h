@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "tinyxml2.h"
+
+class XMLSerializable;
+class XmlDocumentPool;
+
+// Document borrowed from an XmlDocumentPool; returned to the pool, cleared, when destroyed
+class XmlPooledDocument
+{
+public:
+    XmlPooledDocument(XmlPooledDocument&& other) noexcept;
+    XmlPooledDocument& operator=(XmlPooledDocument&& other) noexcept;
+    ~XmlPooledDocument();
+
+    XmlPooledDocument(const XmlPooledDocument&) = delete;
+    XmlPooledDocument& operator=(const XmlPooledDocument&) = delete;
+
+    tinyxml2::XMLDocument& document();
+    tinyxml2::XMLDocument* operator->();
+
+private:
+    friend class XmlDocumentPool;
+
+    XmlPooledDocument(XmlDocumentPool* pool, std::unique_ptr<tinyxml2::XMLDocument> document);
+    void release();
+
+    XmlDocumentPool* m_pool;
+    std::unique_ptr<tinyxml2::XMLDocument> m_document;
+};
+
+// Keeps cleared XMLDocuments for reuse. XMLDocument::Clear() frees the nodes into the document's
+// memory pools without releasing them, so a reused document builds or parses a message of similar
+// size without new node allocations.
+//
+// A pool is not thread-safe and must outlive the documents it hands out; use one per thread,
+// for example local():
+//
+//     XmlDocumentPool& pool = XmlDocumentPool::local();
+//     pool.deserialize(request.data(), request.size(), "Imput", imput);
+//     pool.serialize("Imput", imput, response);
+class XmlDocumentPool
+{
+public:
+    // Documents beyond maxDocuments are destroyed when returned
+    explicit XmlDocumentPool(size_t maxDocuments = 8);
+
+    XmlDocumentPool(const XmlDocumentPool&) = delete;
+    XmlDocumentPool& operator=(const XmlDocumentPool&) = delete;
+
+    // Cleared document, taken from the pool when one is available
+    XmlPooledDocument acquire();
+    // Creates documents up to count so the first requests do not allocate them
+    void reserve(size_t count);
+    size_t available() const;
+
+    // Parses text and deserializes its root element, which must be named rootName, into object
+    bool deserialize(const char* text, size_t size, const char* rootName, XMLSerializable& object);
+    bool deserializeFile(const std::string& filename, const char* rootName, XMLSerializable& object);
+
+    // Serializes object as a rootName document into output, reusing output's capacity
+    bool serialize(const char* rootName, const XMLSerializable& object, std::string& output, bool compact = false);
+    bool serializeFile(const std::string& filename, const char* rootName, const XMLSerializable& object, bool compact = false);
+
+    // Pool of the calling thread
+    static XmlDocumentPool& local();
+
+private:
+    friend class XmlPooledDocument;
+
+    size_t m_maxDocuments;
+    std::vector<std::unique_ptr<tinyxml2::XMLDocument>> m_documents;
+    // Printers keep their buffers between serialize() calls
+    tinyxml2::XMLPrinter m_printer;
+    tinyxml2::XMLPrinter m_compactPrinter;
+
+    void release(std::unique_ptr<tinyxml2::XMLDocument> document);
+    bool deserializeRoot(tinyxml2::XMLDocument& document, const char* rootName, XMLSerializable& object);
+};
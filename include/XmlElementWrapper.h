@@ -1,13 +1,17 @@
 #pragma once
 #include <string>
 #include <iostream>
-#include <cstdlib>
+#include <vector>
 #include "tinyxml2.h"
+#include "XmlDiagnostics.h"
+#include "XmlNumericCodec.h"
 
 class XmlElementWrapper
 {
 public:
     XmlElementWrapper(tinyxml2::XMLElement* element, const char* name, bool createIfNotFound = false);
+    // Wraps an element that has already been located
+    explicit XmlElementWrapper(tinyxml2::XMLElement* element);
 
     tinyxml2::XMLElement* getElement() const;
 
@@ -20,6 +24,11 @@ public:
     bool operator>>(bool& value);
     bool operator>>(double& value);
     bool operator>>(float& value);
+    // Numeric arrays packed into the element text as separated values (see XmlPackedArray)
+    bool operator>>(XmlPackedArray<int>& value);
+    bool operator>>(XmlPackedArray<int64_t>& value);
+    bool operator>>(XmlPackedArray<float>& value);
+    bool operator>>(XmlPackedArray<double>& value);
 
     // Overloaded operator<< for serializing
     bool operator<<(const std::string& value);
@@ -30,11 +39,15 @@ public:
     bool operator<<(bool value);
     bool operator<<(double value);
     bool operator<<(float value);
+    bool operator<<(const XmlPackedArray<int>& value);
+    bool operator<<(const XmlPackedArray<int64_t>& value);
+    bool operator<<(const XmlPackedArray<float>& value);
+    bool operator<<(const XmlPackedArray<double>& value);
 
 private:
     tinyxml2::XMLElement* element;
 
-    void reportError(const char* value);
+    void report(XmlErrorCode code, const char* message) const;
     bool getText(std::string& value);
     bool setText(const std::string& value);
     bool setText(const char* value);
@@ -44,24 +57,121 @@ private:
     {
         if (!element)
         {
-            std::cerr << "Error: Element is null." << std::endl;
+            report(XmlErrorCode::NullElement, "Element is null");
             return false;
         }
-        element->SetText(std::to_string(value).c_str());
+        char buffer[XmlNumericCodec::BufferSize];
+        if (!XmlNumericCodec::format(buffer, sizeof(buffer), value))
+        {
+            report(XmlErrorCode::FormatFailed, "Failed to format value for element");
+            return false;
+        }
+        element->SetText(buffer);
         return true;
     }
 
-    template<typename Func, typename T>
-    bool queryText(Func func, T& value)
+    template<typename T>
+    bool parseText(T& value)
     {
         if (!element)
         {
-            std::cerr << "Error: Element is null." << std::endl;
+            report(XmlErrorCode::NullElement, "Element is null");
             return false;
         }
-        if ((element->*func)(&value) != tinyxml2::XMLError::XML_SUCCESS)
+        const char* text = element->GetText();
+        if (!text)
+        {
+            report(XmlErrorCode::MissingText, "Element text is null");
+            return false;
+        }
+        if (!XmlNumericCodec::parse(text, value))
+        {
+            report(XmlErrorCode::ConversionFailed, "Failed to query value from element");
+            return false;
+        }
+        return true;
+    }
+
+    template<typename T>
+    bool setArray(const std::vector<T>& value);
+
+    template<typename T>
+    bool parseArray(std::vector<T>& value)
+    {
+        if (!element)
+        {
+            report(XmlErrorCode::NullElement, "Element is null");
+            return false;
+        }
+        // An empty element holds an empty array
+        if (!XmlNumericCodec::parseArray(element->GetText(), value))
+        {
+            report(XmlErrorCode::ConversionFailed, "Failed to query array from element");
+            return false;
+        }
+        return true;
+    }
+};
+
+// Attribute-backed counterpart of XmlElementWrapper: reads and writes a scalar as the attribute
+// name of element, converting values the same way as the element operators. Attributes and child
+// elements mix freely on the same element; an attribute costs no extra DOM nodes.
+class XmlAttributeWrapper
+{
+public:
+    XmlAttributeWrapper(tinyxml2::XMLElement* element, const char* name);
+
+    tinyxml2::XMLElement* getElement() const;
+    const char* getName() const;
+    bool exists() const;
+
+    bool operator>>(std::string& value);
+    bool operator>>(int& value);
+    bool operator>>(unsigned int& value);
+    bool operator>>(int64_t& value);
+    bool operator>>(uint64_t& value);
+    bool operator>>(bool& value);
+    bool operator>>(double& value);
+    bool operator>>(float& value);
+
+    bool operator<<(const std::string& value);
+    bool operator<<(int value);
+    bool operator<<(unsigned int value);
+    bool operator<<(int64_t value);
+    bool operator<<(uint64_t value);
+    bool operator<<(bool value);
+    bool operator<<(double value);
+    bool operator<<(float value);
+
+private:
+    tinyxml2::XMLElement* m_element;
+    const char* m_name;
+
+    void report(XmlErrorCode code, const char* message) const;
+    const char* getText();
+    bool setText(const char* value);
+
+    template<typename T>
+    bool setNumber(T value)
+    {
+        char buffer[XmlNumericCodec::BufferSize];
+        if (!XmlNumericCodec::format(buffer, sizeof(buffer), value))
+        {
+            report(XmlErrorCode::FormatFailed, "Failed to format value for attribute");
+            return false;
+        }
+        return setText(buffer);
+    }
+
+    template<typename T>
+    bool parseNumber(T& value)
+    {
+        const char* text = getText();
+        if (!text)
+            return false;
+        if (!XmlNumericCodec::parse(text, value))
         {
-            std::cerr << "Error: Failed to query value from element." << std::endl;
+            report(XmlErrorCode::ConversionFailed, "Failed to query value from attribute");
             return false;
         }
         return true;
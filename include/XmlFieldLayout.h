@@ -0,0 +1,266 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <vector>
+#include "tinyxml2.h"
+#include "XmlSnapshot.h"
+#include "XmlValue.h"
+#include "XmlValueTraits.h"
+
+// Element names for a container field: the container element and one element per item
+struct XmlContainerNames
+{
+    std::string container;
+    std::string item = XmlDefaultItemName;
+};
+
+// Type-specific conversion for a stored value, generated from XmlValueTraits
+struct XmlFieldOps
+{
+    bool (*write)(tinyxml2::XMLElement* parent, const char* name, const XmlValue& value, const char* itemName);
+    bool (*read)(tinyxml2::XMLElement* element, XmlValue& value, const char* itemName);
+    // Like read, but binds nested XMLSerializable objects lazily (see XMLSerializable::deserializeLazy)
+    bool (*readLazy)(tinyxml2::XMLElement* element, XmlValue& value, const char* itemName);
+    // Called when the element is absent; resets optional values and fails for required ones
+    bool (*readMissing)(XmlValue& value);
+    // Rewrites the value into an existing document (see xmlUpdateChild)
+    bool (*update)(tinyxml2::XMLElement* parent, const char* name, XmlValue& value, const char* itemName);
+    // The value as a nested XMLSerializable object, or nullptr for other types
+    XMLSerializable* (*object)(XmlValue& value);
+    // Binary snapshot encoding (see XmlSnapshot.h)
+    bool (*writeSnapshot)(XmlSnapshotWriter& writer, const XmlValue& value);
+    bool (*readSnapshot)(XmlSnapshotReader& reader, XmlValue& value);
+    // Value as the attribute name of element (see xmlWriteAttribute); only for attribute types
+    bool (*writeAttribute)(tinyxml2::XMLElement* element, const char* name, const XmlValue& value);
+    bool (*readAttribute)(tinyxml2::XMLElement* element, const char* name, XmlValue& value);
+    bool attribute;     // True if the type can be stored as an attribute
+
+    // Shared ops for T, or nullptr for types XmlValueTraits does not support
+    template <typename T>
+    static const XmlFieldOps* get()
+    {
+        if constexpr (XmlValueTraits<T>::supported)
+        {
+            // Values are converted in place inside the XmlValue, without copies
+            static const XmlFieldOps ops = {
+                [](tinyxml2::XMLElement* parent, const char* name, const XmlValue& value, const char* itemName)
+                {
+                    return xmlWriteChild(parent, name, *value.get<T>(), itemName);
+                },
+                [](tinyxml2::XMLElement* element, XmlValue& value, const char* itemName)
+                {
+                    return XmlValueTraits<T>::read(element, *value.get<T>(), itemName);
+                },
+                [](tinyxml2::XMLElement* element, XmlValue& value, const char* itemName)
+                {
+                    if constexpr (std::is_base_of<XMLSerializable, T>::value && !XmlHasFields<T>::value)
+                    {
+                        // Classes reading their element themselves cannot be bound lazily
+                        (void)itemName;
+                        if constexpr (XmlCustomDeserialize<T>::value)
+                            return value.get<T>()->deserialize(element);
+                        else
+                            return value.get<T>()->deserializeLazy(element);
+                    }
+                    else
+                    {
+                        return XmlValueTraits<T>::read(element, *value.get<T>(), itemName);
+                    }
+                },
+                [](XmlValue& value)
+                {
+                    if constexpr (XmlIsOptional<T>::value)
+                    {
+                        value.get<T>()->reset();
+                        return true;
+                    }
+                    else
+                    {
+                        (void)value;
+                        return false;
+                    }
+                },
+                [](tinyxml2::XMLElement* parent, const char* name, XmlValue& value, const char* itemName)
+                {
+                    return xmlUpdateChild(parent, name, *value.get<T>(), itemName);
+                },
+                [](XmlValue& value) -> XMLSerializable*
+                {
+                    if constexpr (std::is_base_of<XMLSerializable, T>::value)
+                    {
+                        return value.get<T>();
+                    }
+                    else
+                    {
+                        (void)value;
+                        return nullptr;
+                    }
+                },
+                [](XmlSnapshotWriter& writer, const XmlValue& value)
+                {
+                    return XmlSnapshotTraits<T>::write(writer, *value.get<T>());
+                },
+                [](XmlSnapshotReader& reader, XmlValue& value)
+                {
+                    return XmlSnapshotTraits<T>::read(reader, *value.get<T>());
+                },
+                [](tinyxml2::XMLElement* element, const char* name, const XmlValue& value)
+                {
+                    if constexpr (XmlIsAttributeValue<T>::value)
+                    {
+                        return xmlWriteAttribute(element, name, *value.get<T>());
+                    }
+                    else
+                    {
+                        (void)element, (void)name, (void)value;
+                        return false;
+                    }
+                },
+                [](tinyxml2::XMLElement* element, const char* name, XmlValue& value)
+                {
+                    if constexpr (XmlIsAttributeValue<T>::value)
+                    {
+                        return xmlReadAttribute(element, name, *value.get<T>());
+                    }
+                    else
+                    {
+                        (void)element, (void)name, (void)value;
+                        return false;
+                    }
+                },
+                XmlIsAttributeValue<T>::value
+            };
+            return &ops;
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+};
+
+// Handle to a field of an XmlFieldLayout. Accessing a value through its slot skips the key lookup.
+template <typename T>
+struct XmlSlot
+{
+    size_t index;
+};
+
+// Field names, element names, types and default values of an XMLSerializable class. A class
+// registers its fields once into a shared layout; each instance then only holds an array of values
+// indexed by slot:
+//
+//     static const std::shared_ptr<const XmlFieldLayout>& platformLayout()
+//     {
+//         static const std::shared_ptr<const XmlFieldLayout> layout = []()
+//             {
+//                 auto layout = std::make_shared<XmlFieldLayout>();
+//                 layout->add("ID", std::string(""));
+//                 layout->add("LatitudeDegree", 0);
+//                 return layout;
+//             }();
+//         return layout;
+//     }
+//
+//     Platform() : XMLSerializable(platformLayout()) {}
+//
+// Scalar fields can be stored as attributes of the object's element instead of child elements,
+// per field with addAttribute() or for the whole class with setScalarsAsAttributes().
+//
+// A layout must not be modified once instances use it.
+class XmlFieldLayout
+{
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    struct Field
+    {
+        std::string key;
+        std::string element;               // Element name if it differs from the key
+        std::string item;                  // Item element name for containers
+        const XmlFieldOps* ops = nullptr;  // nullptr for types XmlValueTraits does not support
+        XmlValue defaultValue;             // Also defines the type of the field
+        bool attribute = false;            // Stored as an attribute (see addAttribute)
+    };
+
+    // Adds a field, or replaces the field with the same key, and returns its slot
+    template <typename T>
+    XmlSlot<T> add(const std::string& key, const T& defaultValue = T())
+    {
+        Field field;
+        field.key = key;
+        field.ops = XmlFieldOps::get<T>();
+        field.defaultValue = defaultValue;
+        return XmlSlot<T>{ insert(std::move(field)) };
+    }
+
+    template <typename T>
+    XmlSlot<T> add(const std::string& key, const T& defaultValue, const XmlContainerNames& names)
+    {
+        Field field;
+        field.key = key;
+        field.element = names.container;
+        field.item = names.item;
+        field.ops = XmlFieldOps::get<T>();
+        field.defaultValue = defaultValue;
+        return XmlSlot<T>{ insert(std::move(field)) };
+    }
+
+    // Adds a scalar or optional scalar field stored as an attribute of the object's element
+    template <typename T>
+    XmlSlot<T> addAttribute(const std::string& key, const T& defaultValue = T())
+    {
+        static_assert(XmlIsAttributeValue<T>::value, "Only scalars and optional scalars can be stored as attributes");
+        Field field;
+        field.key = key;
+        field.ops = XmlFieldOps::get<T>();
+        field.defaultValue = defaultValue;
+        field.attribute = true;
+        return XmlSlot<T>{ insert(std::move(field)) };
+    }
+
+    // Stores every scalar and optional scalar field of the class as an attribute; other fields
+    // remain child elements
+    void setScalarsAsAttributes(bool enabled);
+    bool scalarsAsAttributes() const;
+
+    // Slot of an existing field; npos if the key is missing or holds another type
+    template <typename T>
+    XmlSlot<T> slot(std::string_view key) const
+    {
+        size_t index = find(key);
+        return XmlSlot<T>{ index != npos && m_fields[index].defaultValue.holds<T>() ? index : npos };
+    }
+
+    // Slot of key, or npos
+    size_t find(std::string_view key) const;
+
+    size_t size() const;
+    bool empty() const;
+    const Field& field(size_t slot) const;
+
+    // Name the field is read from and written to
+    const char* elementName(size_t slot) const;
+    const char* itemName(size_t slot) const;
+    // Whether the field is read from and written to an attribute rather than a child element
+    bool isAttribute(size_t slot) const;
+
+    // Slots sorted by key (serialization order) and by element name (for deserialization)
+    const std::vector<size_t>& byKey() const;
+    const std::vector<size_t>& byElement() const;
+
+    // Hash of the keys, element names and types in key order; layouts with equal signatures read
+    // each other's snapshots
+    uint64_t signature() const;
+
+private:
+    std::vector<Field> m_fields;
+    std::vector<size_t> m_byKey;
+    std::vector<size_t> m_byElement;
+    uint64_t m_signature = xmlSnapshotHash(nullptr, 0);
+    bool m_scalarsAsAttributes = false;
+
+    size_t insert(Field field);
+};
@@ -0,0 +1,112 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+#include "tinyxml2.h"
+#include "XmlDiagnostics.h"
+#include "XmlElementWrapper.h"
+#include "XmlValueTraits.h"
+
+// Support functions for the structs emitted by tinyxmlhelper_codegen (see codegen/). Generated
+// types hold their fields as plain members and read children in one pass, expecting them in the
+// order of the sample or schema they were generated from.
+
+// Index of the field called name among count names, checking the expected (next in order) field
+// first and then the others in order after it; count if none matches. In-order documents cost one
+// comparison per child element.
+inline size_t xmlGeneratedMatch(const char* const* names, size_t count, const char* name, size_t expected)
+{
+    for (size_t offset = 0; offset < count; ++offset)
+    {
+        size_t index = expected + offset;
+        if (index >= count)
+            index -= count;
+        if (std::strcmp(names[index], name) == 0)
+            return index;
+    }
+    return count;
+}
+
+// Element content: scalars are converted directly, generated structs read their own children.
+// An element without text is an empty string.
+template <typename T>
+bool xmlGeneratedRead(tinyxml2::XMLElement* element, T& value)
+{
+    if constexpr (std::is_same<T, std::string>::value)
+    {
+        const char* text = element->GetText();
+        value = text ? text : "";
+        return true;
+    }
+    else if constexpr (XmlIsScalar<T>::value)
+    {
+        XmlElementWrapper wrapper(element);
+        return wrapper >> value;
+    }
+    else
+    {
+        return value.deserialize(element);
+    }
+}
+
+template <typename T>
+bool xmlGeneratedRead(tinyxml2::XMLElement* element, std::optional<T>& value)
+{
+    if (!value)
+        value.emplace();
+    return xmlGeneratedRead(element, *value);
+}
+
+// Repeated elements append one item each
+template <typename T>
+bool xmlGeneratedRead(tinyxml2::XMLElement* element, std::vector<T>& value)
+{
+    return xmlGeneratedRead(element, value.emplace_back());
+}
+
+template <typename T>
+bool xmlGeneratedWriteContent(tinyxml2::XMLElement* element, const T& value)
+{
+    if constexpr (XmlIsScalar<T>::value)
+    {
+        XmlElementWrapper wrapper(element);
+        return wrapper << value;
+    }
+    else
+    {
+        return value.serialize(element);
+    }
+}
+
+// Appends child elements name holding value: one for a value, none for an empty optional and one
+// per item for a repeated field
+template <typename T>
+bool xmlGeneratedWrite(tinyxml2::XMLElement* parent, const char* name, const T& value)
+{
+    tinyxml2::XMLElement* child = parent->GetDocument()->NewElement(name);
+    parent->InsertEndChild(child);
+    return xmlGeneratedWriteContent(child, value);
+}
+
+template <typename T>
+bool xmlGeneratedWrite(tinyxml2::XMLElement* parent, const char* name, const std::optional<T>& value)
+{
+    return !value || xmlGeneratedWrite(parent, name, *value);
+}
+
+template <typename T>
+bool xmlGeneratedWrite(tinyxml2::XMLElement* parent, const char* name, const std::vector<T>& value)
+{
+    bool allSuccess = true;
+    for (const T& item : value)
+        allSuccess &= xmlGeneratedWrite(parent, name, item);
+    return allSuccess;
+}
+
+// Reports a required field that the element did not contain
+inline void xmlGeneratedMissing(tinyxml2::XMLElement* element, const char* name)
+{
+    XmlDiagnostics::report(XmlErrorCode::ElementNotFound, element, name, "Element missing or invalid");
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a file (mmap with a sequential access hint, or a file mapping on
+// Windows). The contents can be scanned in place, for example by XmlRecordReader, without reading
+// the file into a separate buffer. Whole documents gain nothing from a mapping, since
+// tinyxml2::XMLDocument parses a copy of the text; load those with XMLDocument::LoadFile.
+class XmlMappedFile
+{
+public:
+    XmlMappedFile();
+    explicit XmlMappedFile(const std::string& filename);
+    ~XmlMappedFile();
+
+    XmlMappedFile(const XmlMappedFile&) = delete;
+    XmlMappedFile& operator=(const XmlMappedFile&) = delete;
+    XmlMappedFile(XmlMappedFile&& other) noexcept;
+    XmlMappedFile& operator=(XmlMappedFile&& other) noexcept;
+
+    // Replaces the current mapping; reports IoFailed and returns false if the file cannot be mapped
+    bool open(const std::string& filename);
+    void close();
+
+    bool isOpen() const;
+    // Mapped contents; nullptr for an empty file
+    const char* data() const;
+    size_t size() const;
+
+private:
+    const char* m_data;
+    size_t m_size;
+    bool m_open;
+};
@@ -0,0 +1,143 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <typeinfo>
+
+// Opt-in performance counters for serialization. With TINYXMLHELPER_ENABLE_METRICS defined (CMake
+// option TINYXMLHELPER_METRICS) the library counts, per class and key, how often fields are looked
+// up, missing, converted and failed, and times XMLSerializable::serialize/deserialize per class.
+// Without it the recording calls are empty inline functions and snapshot() returns no data.
+//
+// Counters are kept per thread and merged when a snapshot is taken:
+//
+//     XmlMetricsSnapshot metrics = XmlMetrics::snapshot();
+//     std::cout << metrics.toText();
+//     XmlMetrics::reset();
+
+enum class XmlMetricEvent
+{
+    Lookup,     // Field or child element looked up
+    Miss,       // Looked-up element absent, or an element no field expects
+    Conversion, // Value converted from or to element content
+    Failure     // Value could not be read or written
+};
+
+enum class XmlMetricsPhase
+{
+    None,       // Sets the class for counters without timing
+    Serialize,
+    Deserialize
+};
+
+struct XmlKeyCounters
+{
+    uint64_t lookups = 0;
+    uint64_t misses = 0;
+    uint64_t conversions = 0;
+    uint64_t failures = 0;
+
+    void merge(const XmlKeyCounters& other);
+};
+
+// Durations in power-of-two buckets: bucket i counts durations below 2^(i+1) ns
+struct XmlTimingHistogram
+{
+    static constexpr size_t Buckets = 40;
+
+    uint64_t count = 0;
+    uint64_t totalNanoseconds = 0;
+    uint64_t maxNanoseconds = 0;
+    std::array<uint64_t, Buckets> buckets{};
+
+    void add(uint64_t nanoseconds);
+    void merge(const XmlTimingHistogram& other);
+    // Upper bound of the bucket holding the given fraction (0 to 1) of the durations
+    uint64_t percentile(double fraction) const;
+};
+
+struct XmlClassMetrics
+{
+    XmlTimingHistogram serialize;
+    XmlTimingHistogram deserialize;
+    std::map<std::string, XmlKeyCounters> keys;
+
+    void merge(const XmlClassMetrics& other);
+};
+
+struct XmlMetricsSnapshot
+{
+    // By class name; counters recorded outside any class are listed under an empty name
+    std::map<std::string, XmlClassMetrics> classes;
+
+    bool empty() const;
+    void merge(const XmlMetricsSnapshot& other);
+
+    std::string toText() const;
+    std::string toJson() const;
+};
+
+class XmlMetrics
+{
+public:
+    // Process-wide switch; recording is a single flag test while disabled
+    static void setEnabled(bool enabled);
+
+#ifdef TINYXMLHELPER_ENABLE_METRICS
+    static bool enabled();
+
+    // Counts event for key under the class of the innermost XmlMetricsScope
+    static void record(XmlMetricEvent event, const char* key)
+    {
+        if (enabled())
+            dispatch(event, key);
+    }
+#else
+    static constexpr bool enabled() { return false; }
+    static void record(XmlMetricEvent, const char*) {}
+#endif
+
+    // Counters of all threads, including threads that have exited since the last reset
+    static XmlMetricsSnapshot snapshot();
+    static void reset();
+
+private:
+    friend class XmlMetricsScope;
+
+    static void dispatch(XmlMetricEvent event, const char* key);
+};
+
+// Sets the class counters are recorded under for the lifetime of the scope and, for the serialize
+// and deserialize phases, adds the scope's duration to that class's histogram. XMLSerializable
+// opens one in serialize() and deserialize(); overrides that do not call the base class can open
+// their own:
+//
+//     XmlMetricsScope metrics(typeid(*this), XmlMetricsPhase::Deserialize);
+#ifdef TINYXMLHELPER_ENABLE_METRICS
+class XmlMetricsScope
+{
+public:
+    explicit XmlMetricsScope(const std::type_info& type, XmlMetricsPhase phase = XmlMetricsPhase::None);
+    ~XmlMetricsScope();
+
+    XmlMetricsScope(const XmlMetricsScope&) = delete;
+    XmlMetricsScope& operator=(const XmlMetricsScope&) = delete;
+
+private:
+    const std::type_info* m_previous;
+    XmlMetricsPhase m_phase;
+    std::chrono::steady_clock::time_point m_start;
+};
+#else
+class XmlMetricsScope
+{
+public:
+    explicit XmlMetricsScope(const std::type_info&, XmlMetricsPhase = XmlMetricsPhase::None) {}
+
+    XmlMetricsScope(const XmlMetricsScope&) = delete;
+    XmlMetricsScope& operator=(const XmlMetricsScope&) = delete;
+};
+#endif
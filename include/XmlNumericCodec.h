@@ -0,0 +1,150 @@
+#pragma once
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+// Locale-independent numeric text conversion built on std::to_chars/std::from_chars.
+// Formatting writes into caller-provided (typically stack) buffers and never allocates;
+// floating point values use the shortest representation that round-trips exactly.
+// Parsing is strict: surrounding XML whitespace and a leading '+' are accepted, anything
+// else that is not part of the number makes the conversion fail.
+class XmlNumericCodec
+{
+public:
+    // Large enough for any supported value plus the terminating null
+    static constexpr size_t BufferSize = 32;
+
+    // Writes value as a null-terminated string, returns its length or 0 if it does not fit
+    template <typename T>
+    static size_t format(char* buffer, size_t size, T value)
+    {
+        static_assert(std::is_arithmetic<T>::value, "XmlNumericCodec only formats numbers");
+        if (size == 0)
+            return 0;
+        std::to_chars_result result = std::to_chars(buffer, buffer + size - 1, value);
+        if (result.ec != std::errc())
+            return 0;
+        *result.ptr = '\0';
+        return static_cast<size_t>(result.ptr - buffer);
+    }
+
+    static size_t format(char* buffer, size_t size, bool value);
+
+    // Parses the whole of text into value; value is left untouched on failure
+    template <typename T>
+    static bool parse(const char* text, T& value)
+    {
+        static_assert(std::is_arithmetic<T>::value, "XmlNumericCodec only parses numbers");
+        const char* first;
+        const char* last;
+        if (!trim(text, first, last))
+            return false;
+        if (*first == '+' && last - first > 1 && first[1] != '-')
+            ++first;
+
+        T result;
+        std::from_chars_result parsed = std::from_chars(first, last, result);
+        if (parsed.ec != std::errc() || parsed.ptr != last)
+            return false;
+        value = result;
+        return true;
+    }
+
+    // Accepts true/True/TRUE, false/False/FALSE and integers (non-zero is true), like tinyxml2
+    static bool parse(const char* text, bool& value);
+
+    // Appends count values separated by delimiter to output. Space for the whole array is reserved
+    // up front and numbers are written straight into it; output is unchanged on failure.
+    template <typename T>
+    static bool formatArray(std::string& output, const T* values, size_t count, char delimiter = ' ')
+    {
+        static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, "XmlNumericCodec only formats numeric arrays");
+        size_t start = output.size();
+        output.resize(start + count * BufferSize);
+        char* position = &output[0] + start;
+        char* end = &output[0] + output.size();
+        for (size_t index = 0; index < count; ++index)
+        {
+            if (index > 0)
+                *position++ = delimiter;
+            std::to_chars_result result = std::to_chars(position, end, values[index]);
+            if (result.ec != std::errc())
+            {
+                output.resize(start);
+                return false;
+            }
+            position = result.ptr;
+        }
+        output.resize(static_cast<size_t>(position - output.data()));
+        return true;
+    }
+
+    // Parses numbers separated by XML whitespace and/or commas into values, reusing its capacity.
+    // Empty or all-separator text gives an empty array; on failure values is cleared.
+    template <typename T>
+    static bool parseArray(const char* text, std::vector<T>& values)
+    {
+        static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, "XmlNumericCodec only parses numeric arrays");
+        values.clear();
+        if (!text)
+            return true;
+        const char* position = text;
+        const char* end = text + std::strlen(text);
+
+        // Separator count bounds the item count, so the array is allocated once
+        size_t separators = static_cast<size_t>(std::count_if(position, end, [](char c) { return isSeparator(c); }));
+        values.reserve(separators + 1);
+
+        while (true)
+        {
+            while (position != end && isSeparator(*position))
+                ++position;
+            if (position == end)
+                return true;
+            if (*position == '+' && end - position > 1 && position[1] != '-')
+                ++position;
+
+            T value;
+            std::from_chars_result parsed = std::from_chars(position, end, value);
+            if (parsed.ec != std::errc() || (parsed.ptr != end && !isSeparator(*parsed.ptr)))
+            {
+                values.clear();
+                return false;
+            }
+            values.push_back(value);
+            position = parsed.ptr;
+        }
+    }
+
+private:
+    static bool isSeparator(char c)
+    {
+        return c == ' ' || c == ',' || c == '\n' || c == '\t' || c == '\r';
+    }
+
+    // Strips XML whitespace; false if nothing is left
+    static bool trim(const char* text, const char*& first, const char*& last);
+};
+
+// Numeric vector stored as separated values in the text of one element, <Samples>1.5 2 3</Samples>,
+// instead of one item element per value as for std::vector<T>. Use it in place of std::vector<T>
+// for fields, bound struct members and the XmlElementWrapper operators holding long numeric
+// sequences. The two formats do not read each other, so the packed one is only used where this
+// type is named; converting from a std::vector is explicit for the same reason.
+template <typename T>
+class XmlPackedArray : public std::vector<T>
+{
+    static_assert(std::is_same<T, int>::value || std::is_same<T, int64_t>::value || std::is_same<T, float>::value
+        || std::is_same<T, double>::value, "XmlPackedArray holds int, int64_t, float or double");
+
+public:
+    using std::vector<T>::vector;
+    XmlPackedArray() = default;
+    explicit XmlPackedArray(std::vector<T> values) : std::vector<T>(std::move(values)) {}
+};
@@ -0,0 +1,208 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+#include "tinyxml2.h"
+#include "XmlDiagnostics.h"
+#include "XmlStreamWriter.h"
+#include "XmlThreadPool.h"
+#include "XmlValueTraits.h"
+
+// Parallel (de)serialization of large collections of sibling elements, such as the <Platform>
+// children of a <PlatformSet>:
+//
+//     std::vector<Platform> platforms;
+//     XmlParallel::deserialize(platformSet, "Platform", platforms);
+//     XmlParallel::serialize(outputSet, "Platform", platforms);
+//
+// Items are processed in chunks on an XmlThreadPool. Results keep document order, serialized
+// output is byte-identical to a sequential run, and diagnostics reported by the items are
+// collected per chunk and replayed to the caller's sink in document order. Error hooks overridden
+// by the item type run on the worker threads and must be thread-safe; if one throws, the exception
+// of the first failing chunk is rethrown on the calling thread.
+class XmlParallel
+{
+public:
+    // Collections smaller than this are processed on the calling thread
+    static constexpr size_t MinParallelItems = 256;
+
+    // Deserializes every itemName child of parent into items, replacing its contents
+    template <typename T>
+    static bool deserialize(tinyxml2::XMLElement* parent, const char* itemName, std::vector<T>& items,
+        XmlThreadPool& pool = XmlThreadPool::shared())
+    {
+        static_assert(XmlValueTraits<T>::supported, "Type is not supported for XML deserialization");
+        items.clear();
+        if (!parent)
+        {
+            XmlDiagnostics::report(XmlErrorCode::NullElement, nullptr, itemName, "Parent element is null");
+            return false;
+        }
+
+        // Snapshot of the children, so workers can index them directly
+        std::vector<tinyxml2::XMLElement*> elements;
+        for (tinyxml2::XMLElement* child = parent->FirstChildElement(itemName); child; child = child->NextSiblingElement(itemName))
+            elements.push_back(child);
+
+        items.resize(elements.size());
+        size_t chunks = chunkCount(elements.size(), pool);
+        return forEachChunk(chunks, pool, [&](size_t, size_t begin, size_t end)
+            {
+                bool allSuccess = true;
+                for (size_t index = begin; index < end; ++index)
+                    allSuccess &= XmlValueTraits<T>::read(elements[index], items[index], itemName);
+                return allSuccess;
+            }, elements.size());
+    }
+
+    // Serializes items as itemName children of parent. Each thread builds a range of items in a
+    // document of its own; the ranges are then copied into parent in order, giving the same
+    // elements as a sequential serialize. A tinyxml2 document allocates nodes from pools that
+    // only one thread may use, so that copy runs on the calling thread and visits every node a
+    // second time: only the value conversion runs in parallel, and this does not scale with the
+    // number of cores. Use the XmlStreamWriter overload, which joins formatted buffers, when
+    // throughput matters.
+    template <typename T>
+    static bool serialize(tinyxml2::XMLElement* parent, const char* itemName, const std::vector<T>& items,
+        XmlThreadPool& pool = XmlThreadPool::shared())
+    {
+        static_assert(XmlValueTraits<T>::supported, "Type is not supported for XML serialization");
+        if (!parent)
+        {
+            XmlDiagnostics::report(XmlErrorCode::NullElement, nullptr, itemName, "Parent element is null");
+            return false;
+        }
+
+        size_t chunks = chunkCount(items.size(), pool);
+        if (chunks == 1)
+            return writeItems(parent, itemName, items, 0, items.size());
+
+        // Chunk roots carry the parent's name, so diagnostic paths only need their prefix replaced
+        std::vector<tinyxml2::XMLDocument> documents(chunks);
+        bool allSuccess = forEachChunk(chunks, pool, [&](size_t chunk, size_t begin, size_t end)
+            {
+                tinyxml2::XMLElement* root = documents[chunk].NewElement(parent->Name());
+                documents[chunk].InsertEndChild(root);
+                return writeItems(root, itemName, items, begin, end);
+            }, items.size(), parent);
+
+        tinyxml2::XMLDocument* document = parent->GetDocument();
+        for (const tinyxml2::XMLDocument& chunk : documents)
+        {
+            for (const tinyxml2::XMLNode* child = chunk.RootElement()->FirstChild(); child; child = child->NextSibling())
+                parent->InsertEndChild(child->DeepClone(document));
+        }
+        return allSuccess;
+    }
+
+    // Writes items as itemName elements into the element open in writer. Each thread formats a
+    // range of items into a buffer of its own; the buffers are then written in order, giving the
+    // same bytes as writing the items one by one. Only the buffer append is serial, so this is the
+    // overload that scales.
+    template <typename T>
+    static bool serialize(XmlStreamWriter& writer, const char* itemName, const std::vector<T>& items,
+        XmlThreadPool& pool = XmlThreadPool::shared())
+    {
+        if (writer.depth() == 0)
+        {
+            XmlDiagnostics::report(XmlErrorCode::InvalidState, nullptr, itemName, "Collections are written inside an open element");
+            return false;
+        }
+
+        size_t chunks = chunkCount(items.size(), pool);
+        if (chunks == 1)
+            return writeItems(writer, itemName, items, 0, items.size());
+
+        std::vector<std::unique_ptr<XmlStreamWriter>> buffers(chunks);
+        bool allSuccess = forEachChunk(chunks, pool, [&](size_t chunk, size_t begin, size_t end)
+            {
+                buffers[chunk] = std::make_unique<XmlStreamWriter>(writer.isCompact(), writer.depth());
+                return writeItems(*buffers[chunk], itemName, items, begin, end);
+            }, items.size());
+
+        for (const auto& buffer : buffers)
+            allSuccess &= writer.writeRaw(buffer->buffer(), buffer->size());
+        return allSuccess;
+    }
+
+private:
+    // Number of ranges to split count items into; 1 means the calling thread does all the work
+    static size_t chunkCount(size_t count, XmlThreadPool& pool)
+    {
+        if (count < MinParallelItems || pool.concurrency() == 1)
+            return 1;
+        // A few ranges per thread, so threads that finish early pick up remaining work
+        return std::min(count, pool.concurrency() * 4);
+    }
+
+    template <typename T>
+    static bool writeItems(tinyxml2::XMLElement* parent, const char* itemName, const std::vector<T>& items, size_t begin, size_t end)
+    {
+        bool allSuccess = true;
+        for (size_t index = begin; index < end; ++index)
+        {
+            tinyxml2::XMLElement* child = parent->GetDocument()->NewElement(itemName);
+            parent->InsertEndChild(child);
+            allSuccess &= XmlValueTraits<T>::write(child, items[index], itemName);
+        }
+        return allSuccess;
+    }
+
+    template <typename T>
+    static bool writeItems(XmlStreamWriter& writer, const char* itemName, const std::vector<T>& items, size_t begin, size_t end)
+    {
+        bool allSuccess = true;
+        for (size_t index = begin; index < end; ++index)
+            allSuccess &= writer.write(itemName, items[index]);
+        return allSuccess;
+    }
+
+    // Runs process(chunk, begin, end) over count items split into chunks and replays the chunks'
+    // diagnostics in order. For chunks built under a stand-in for parent, the stand-in's name at
+    // the start of each path is replaced by the path of parent.
+    template <typename Process>
+    static bool forEachChunk(size_t chunks, XmlThreadPool& pool, Process process, size_t count,
+        const tinyxml2::XMLElement* parent = nullptr)
+    {
+        if (chunks == 1)
+            return process(0, 0, count);
+
+        std::vector<XmlCollectingSink> sinks(chunks);
+        std::vector<char> results(chunks, 1);
+        std::exception_ptr error;
+        try
+        {
+            pool.run(chunks, [&](size_t chunk)
+                {
+                    XmlScopedSink scope(sinks[chunk]);
+                    results[chunk] = process(chunk, count * chunk / chunks, count * (chunk + 1) / chunks);
+                });
+        }
+        catch (...)
+        {
+            // Rethrown once the collected diagnostics have been delivered
+            error = std::current_exception();
+        }
+
+        std::string parentPath = parent ? XmlDiagnostics::path(parent) : std::string();
+        size_t prefix = parent ? std::strlen(parent->Name()) : 0;
+        bool allSuccess = true;
+        for (size_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            for (XmlDiagnostic diagnostic : sinks[chunk].diagnostics())
+            {
+                if (parent && diagnostic.path.compare(0, prefix, parent->Name()) == 0)
+                    diagnostic.path.replace(0, prefix, parentPath);
+                XmlDiagnostics::sink().report(diagnostic);
+            }
+            allSuccess &= results[chunk] != 0;
+        }
+        if (error)
+            std::rethrow_exception(error);
+        return allSuccess;
+    }
+};
@@ -0,0 +1,169 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "tinyxml2.h"
+#include "XmlDiagnostics.h"
+#include "XmlValueTraits.h"
+
+// Element path compiled once and evaluated against any number of documents. Steps are child
+// element names separated by '/'; a plain step follows the first child of that name, "[n]" the
+// n-th one (from 0) and "[*]" every one of them:
+//
+//     static const XmlPath platformIds("LocationSet/PlatformSet/Platform[*]/ID");
+//     for (tinyxml2::XMLElement* id : platformIds.select(root)) { ... }
+//
+//     static const XmlPath firstName("LocationSet/PlatformSet/Platform/Name");
+//     std::string name;
+//     deserialize(root, firstName, name);
+//
+// Paths are immutable, so one instance can be evaluated by several threads at once. An invalid
+// path is reported as ParseFailed when constructed and matches nothing.
+class XmlPath
+{
+public:
+    class Iterator;
+    class Range;
+
+    XmlPath() = default;
+    explicit XmlPath(std::string_view path);
+
+    bool valid() const;
+    const std::string& text() const;
+    // True if a "[*]" step can select more than one element
+    bool multiple() const;
+
+    // First selected element under root, or nullptr
+    tinyxml2::XMLElement* first(tinyxml2::XMLElement* root) const;
+    // All selected elements under root, in document order
+    Range select(tinyxml2::XMLElement* root) const;
+    size_t count(tinyxml2::XMLElement* root) const;
+
+private:
+    static constexpr size_t FirstChild = static_cast<size_t>(-1);
+    static constexpr size_t AllChildren = static_cast<size_t>(-2);
+
+    struct Step
+    {
+        std::string name;
+        size_t index = FirstChild;  // Position among same-named siblings, FirstChild or AllChildren
+    };
+
+    std::string m_text;
+    std::vector<Step> m_steps;
+    bool m_valid = true;
+    bool m_multiple = false;
+
+    bool parse(std::string_view path);
+    // Element selected by step level under parent after current (nullptr: the first one)
+    tinyxml2::XMLElement* next(size_t level, tinyxml2::XMLElement* parent, tinyxml2::XMLElement* current) const;
+};
+
+// Forward iterator over the selected elements. Holds one position per step, so advancing
+// resumes the walk instead of restarting it.
+class XmlPath::Iterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = tinyxml2::XMLElement*;
+    using difference_type = std::ptrdiff_t;
+    using pointer = tinyxml2::XMLElement* const*;
+    using reference = tinyxml2::XMLElement* const&;
+
+    Iterator() = default;
+
+    reference operator*() const { return m_positions.back(); }
+    Iterator& operator++();
+    Iterator operator++(int)
+    {
+        Iterator previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    bool operator==(const Iterator& other) const { return m_positions == other.m_positions; }
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+private:
+    friend class XmlPath;
+
+    const XmlPath* m_path = nullptr;
+    tinyxml2::XMLElement* m_root = nullptr;
+    std::vector<tinyxml2::XMLElement*> m_positions;  // Empty at the end
+
+    Iterator(const XmlPath* path, tinyxml2::XMLElement* root);
+    void advance(size_t level);
+};
+
+class XmlPath::Range
+{
+public:
+    Range(Iterator begin, Iterator end) : m_begin(std::move(begin)), m_end(std::move(end)) {}
+    Iterator begin() const { return m_begin; }
+    Iterator end() const { return m_end; }
+    bool empty() const { return m_begin == m_end; }
+
+private:
+    Iterator m_begin;
+    Iterator m_end;
+};
+
+// Reads value from the first element path selects under element, converting it like
+// deserialize(element, name, value). A missing optional is reset without error.
+template <typename T>
+bool deserialize(tinyxml2::XMLElement* element, const XmlPath& path, T& value, const char* itemName = XmlDefaultItemName)
+{
+    static_assert(XmlValueTraits<T>::supported, "Type is not supported for XML deserialization");
+    tinyxml2::XMLElement* target = path.first(element);
+    if (!target)
+    {
+        if constexpr (XmlIsOptional<T>::value)
+        {
+            if (element && path.valid())
+            {
+                value.reset();
+                return true;
+            }
+        }
+        XmlDiagnostics::report(element ? XmlErrorCode::ElementNotFound : XmlErrorCode::NullElement, element,
+            path.text().c_str(), element ? "Path selects no element" : "Parent element is null");
+        return false;
+    }
+    return XmlValueTraits<T>::read(target, value, itemName);
+}
+
+// For paths with a "[*]" step, reads every selected element as one item of values; other paths
+// read the single selected element as a container, like the overload above
+template <typename T, typename Allocator>
+bool deserialize(tinyxml2::XMLElement* element, const XmlPath& path, std::vector<T, Allocator>& values, const char* itemName = XmlDefaultItemName)
+{
+    static_assert(XmlValueTraits<T>::supported, "Type is not supported for XML deserialization");
+    if (!path.multiple())
+        return deserialize<std::vector<T, Allocator>>(element, path, values, itemName);
+    if (!element)
+    {
+        XmlDiagnostics::report(XmlErrorCode::NullElement, nullptr, path.text().c_str(), "Parent element is null");
+        return false;
+    }
+
+    XmlPath::Range selected = path.select(element);
+    values.clear();
+    values.reserve(path.count(element));
+    bool allSuccess = true;
+    for (tinyxml2::XMLElement* target : selected)
+    {
+        if constexpr (std::is_same<T, bool>::value)
+        {
+            bool item = false;
+            allSuccess &= XmlValueTraits<bool>::read(target, item, itemName);
+            values.push_back(item);
+        }
+        else
+        {
+            allSuccess &= XmlValueTraits<T>::read(target, values.emplace_back(), itemName);
+        }
+    }
+    return allSuccess;
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "tinyxml2.h"
+#include "XMLSerializable.h"
+#include "XmlMappedFile.h"
+
+// Streaming reader that yields the records found at a fixed element path one at a time, without
+// building a DOM for the whole document. Only the current record is parsed (into a reused
+// XMLDocument), so memory stays bounded by the size of one record.
+//
+//     XmlRecordReader reader("input.xml", "Imput/LocationSet/PlatformSet/Platform");
+//     Platform platform;
+//     while (reader.next(platform)) { ... }
+class XmlRecordReader
+{
+public:
+    XmlRecordReader(const std::string& filename, const std::string& recordPath);
+    // Scans an in-memory document in place; data must outlive the reader
+    XmlRecordReader(const char* data, size_t size, const std::string& recordPath);
+    // Scans a memory-mapped file in place; file must outlive the reader
+    XmlRecordReader(const XmlMappedFile& file, const std::string& recordPath);
+    ~XmlRecordReader();
+
+    XmlRecordReader(const XmlRecordReader&) = delete;
+    XmlRecordReader& operator=(const XmlRecordReader&) = delete;
+
+    bool isOpen() const;
+    bool hasError() const;
+    size_t recordCount() const;
+
+    // Returns the next record element, valid until the following call; nullptr at end of input or on error
+    tinyxml2::XMLElement* nextElement();
+
+    // Deserializes the next record into record; returns false at end of input or when the input
+    // is malformed. A record with missing or invalid fields is still returned (true), with the
+    // defaults deserialize() leaves in place; lastRecordValid() tells the two apart.
+    bool next(XMLSerializable& record);
+
+    // Whether the record last returned by next() or passed to forEach() deserialized without errors
+    bool lastRecordValid() const;
+    // Records that were returned but failed to deserialize
+    size_t invalidCount() const;
+
+    // Calls callback(T&) for each remaining record; a callback returning false stops the scan.
+    // Records that fail to deserialize are passed on too, see lastRecordValid().
+    template <typename T, typename Callback>
+    size_t forEach(Callback callback)
+    {
+        size_t count = 0;
+        for (tinyxml2::XMLElement* element = nextElement(); element; element = nextElement())
+        {
+            T record;
+            setRecordValid(record.deserialize(element));
+            ++count;
+            if constexpr (std::is_same<decltype(callback(record)), bool>::value)
+            {
+                if (!callback(record))
+                    break;
+            }
+            else
+            {
+                callback(record);
+            }
+        }
+        return count;
+    }
+
+private:
+    static constexpr size_t BufferSize = 64 * 1024;
+    static constexpr size_t NoMark = static_cast<size_t>(-1);
+
+    FILE* m_file;
+    std::vector<char> m_storage;
+    const char* m_data;
+    size_t m_size;
+    size_t m_pos;
+    size_t m_mark;          // First byte that must survive a refill (open tag or record start)
+    size_t m_tag;           // Start of the markup being scanned
+    std::vector<std::string> m_path;
+    size_t m_depth;
+    size_t m_matched;       // Number of leading path components matched by the open elements
+    bool m_capturing;
+    bool m_error;
+    size_t m_count;
+    bool m_lastValid;
+    size_t m_invalid;
+    tinyxml2::XMLDocument m_document;
+
+    void setRecordValid(bool valid);
+    void setPath(const std::string& recordPath);
+    bool fill();
+    int get();
+    bool skipTo(char target);
+    bool skipPast(const char* terminator);
+    bool skipDeclaration();
+    bool closeElement();
+    void fail(const std::string& message);
+};
+
+// Input range over the records of a reader:
+//     for (Platform& platform : XmlRecordRange<Platform>(reader)) { ... }
+template <typename T>
+class XmlRecordRange
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        iterator() : m_range(nullptr) {}
+        explicit iterator(XmlRecordRange* range) : m_range(range) { advance(); }
+
+        T& operator*() const { return m_range->m_current; }
+        T* operator->() const { return &m_range->m_current; }
+        iterator& operator++() { advance(); return *this; }
+        bool operator==(const iterator& other) const { return m_range == other.m_range; }
+        bool operator!=(const iterator& other) const { return m_range != other.m_range; }
+
+    private:
+        XmlRecordRange* m_range;
+
+        void advance()
+        {
+            m_range->m_current = T();
+            if (!m_range->m_reader.next(m_range->m_current))
+                m_range = nullptr;
+        }
+    };
+
+    explicit XmlRecordRange(XmlRecordReader& reader) : m_reader(reader) {}
+
+    iterator begin() { return iterator(this); }
+    iterator end() { return iterator(); }
+
+private:
+    XmlRecordReader& m_reader;
+    T m_current;
+};
@@ -0,0 +1,402 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#include "XmlValueTraits.h"
+
+class XMLSerializable;
+
+// 64-bit hash used for snapshot keys and layout signatures; FNV-1a style over 8-byte words
+uint64_t xmlSnapshotHash(const void* data, size_t size, uint64_t seed = 14695981039346656037ull);
+
+// Appends values in the binary snapshot format: unsigned integers and lengths as LEB128 varints,
+// signed integers zigzag-encoded, floating point values as little-endian IEEE 754 bit patterns and
+// strings as length plus bytes.
+class XmlSnapshotWriter
+{
+public:
+    // Output buffer, for example to reuse its capacity
+    std::string& buffer() { return m_buffer; }
+    const std::string& data() const { return m_buffer; }
+
+    void writeVarint(uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            m_buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        m_buffer.push_back(static_cast<char>(value));
+    }
+
+    void writeFixed(uint64_t value, size_t bytes)
+    {
+        for (size_t byte = 0; byte < bytes; ++byte)
+            m_buffer.push_back(static_cast<char>((value >> (byte * 8)) & 0xff));
+    }
+
+    void write(const std::string& value)
+    {
+        writeVarint(value.size());
+        m_buffer.append(value);
+    }
+
+    void write(int value) { writeSigned(value); }
+    void write(int64_t value) { writeSigned(value); }
+    void write(unsigned int value) { writeVarint(value); }
+    void write(uint64_t value) { writeVarint(value); }
+    void write(bool value) { m_buffer.push_back(value ? 1 : 0); }
+
+    void write(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        writeFixed(bits, sizeof(bits));
+    }
+
+    void write(double value)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        writeFixed(bits, sizeof(bits));
+    }
+
+private:
+    std::string m_buffer;
+
+    void writeSigned(int64_t value)
+    {
+        writeVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+};
+
+// Reads values written by XmlSnapshotWriter from a buffer it does not own. The first malformed or
+// out-of-range value puts the reader into a failed state, after which every read fails.
+class XmlSnapshotReader
+{
+public:
+    XmlSnapshotReader(const char* data, size_t size) : m_position(data), m_end(data + size), m_failed(false) {}
+
+    bool failed() const { return m_failed; }
+    bool atEnd() const { return m_position == m_end; }
+    const char* position() const { return m_position; }
+    size_t remaining() const { return static_cast<size_t>(m_end - m_position); }
+    // Marks the data as unusable, for example after a signature mismatch
+    bool fail()
+    {
+        m_failed = true;
+        m_position = m_end;
+        return false;
+    }
+
+    bool readVarint(uint64_t& value)
+    {
+        value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7)
+        {
+            if (m_position == m_end)
+                return fail();
+            uint8_t byte = static_cast<uint8_t>(*m_position++);
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return fail();
+    }
+
+    bool readFixed(uint64_t& value, size_t bytes)
+    {
+        if (static_cast<size_t>(m_end - m_position) < bytes)
+            return fail();
+        value = 0;
+        for (size_t byte = 0; byte < bytes; ++byte)
+            value |= static_cast<uint64_t>(static_cast<uint8_t>(*m_position++)) << (byte * 8);
+        return true;
+    }
+
+    bool read(std::string& value)
+    {
+        uint64_t size;
+        if (!readVarint(size) || size > static_cast<uint64_t>(m_end - m_position))
+            return fail();
+        value.assign(m_position, static_cast<size_t>(size));
+        m_position += size;
+        return true;
+    }
+
+    bool read(int& value) { return readSigned(value); }
+    bool read(int64_t& value) { return readSigned(value); }
+    bool read(unsigned int& value) { return readUnsigned(value); }
+    bool read(uint64_t& value) { return readVarint(value); }
+
+    bool read(bool& value)
+    {
+        if (m_position == m_end || static_cast<uint8_t>(*m_position) > 1)
+            return fail();
+        value = *m_position++ != 0;
+        return true;
+    }
+
+    bool read(float& value)
+    {
+        uint64_t bits;
+        if (!readFixed(bits, sizeof(uint32_t)))
+            return false;
+        uint32_t bits32 = static_cast<uint32_t>(bits);
+        std::memcpy(&value, &bits32, sizeof(value));
+        return true;
+    }
+
+    bool read(double& value)
+    {
+        uint64_t bits;
+        if (!readFixed(bits, sizeof(bits)))
+            return false;
+        std::memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+
+    // Reads a count of items that take at least one byte each, rejecting counts the remaining
+    // data cannot hold before anything is allocated for them
+    bool readCount(size_t& count)
+    {
+        uint64_t value;
+        if (!readVarint(value) || value > static_cast<uint64_t>(m_end - m_position))
+            return fail();
+        count = static_cast<size_t>(value);
+        return true;
+    }
+
+private:
+    const char* m_position;
+    const char* m_end;
+    bool m_failed;
+
+    template <typename T>
+    bool readSigned(T& value)
+    {
+        uint64_t encoded;
+        if (!readVarint(encoded))
+            return false;
+        int64_t decoded = static_cast<int64_t>(encoded >> 1) ^ -static_cast<int64_t>(encoded & 1);
+        if (decoded < static_cast<int64_t>(std::numeric_limits<T>::min()) || decoded > static_cast<int64_t>(std::numeric_limits<T>::max()))
+            return fail();
+        value = static_cast<T>(decoded);
+        return true;
+    }
+
+    template <typename T>
+    bool readUnsigned(T& value)
+    {
+        uint64_t decoded;
+        if (!readVarint(decoded))
+            return false;
+        if (decoded > static_cast<uint64_t>(std::numeric_limits<T>::max()))
+            return fail();
+        value = static_cast<T>(decoded);
+        return true;
+    }
+};
+
+// Binary counterpart of XmlValueTraits, for the same set of types. Objects with fields (XMLSerializable
+// layouts and XML_FIELDS structs) start with a signature of their field names and types, so data
+// written by a different version of a class is rejected instead of misread.
+template <typename T, typename = void>
+struct XmlSnapshotTraits
+{
+    static constexpr bool supported = false;
+};
+
+template <typename T>
+struct XmlSnapshotTraits<T, typename std::enable_if<XmlIsScalar<T>::value>::type>
+{
+    static constexpr bool supported = true;
+
+    static bool write(XmlSnapshotWriter& writer, const T& value)
+    {
+        writer.write(value);
+        return true;
+    }
+
+    static bool read(XmlSnapshotReader& reader, T& value) { return reader.read(value); }
+};
+
+template <typename T>
+struct XmlSnapshotTraits<T, typename std::enable_if<std::is_base_of<XMLSerializable, T>::value && !XmlHasFields<T>::value>::type>
+{
+    static constexpr bool supported = true;
+
+    static bool write(XmlSnapshotWriter& writer, const T& value) { return value.writeSnapshot(writer); }
+    static bool read(XmlSnapshotReader& reader, T& value) { return value.readSnapshot(reader); }
+};
+
+template <typename T>
+struct XmlSnapshotTraits<T, typename std::enable_if<XmlHasFields<T>::value>::type>
+{
+    static constexpr bool supported = true;
+
+    static bool write(XmlSnapshotWriter& writer, const T& value)
+    {
+        writer.writeFixed(signature(), sizeof(uint64_t));
+        bool allSuccess = true;
+        std::apply([&](const auto&... field)
+            {
+                ((allSuccess = allSuccess && XmlSnapshotTraits<std::decay_t<decltype(value.*(field.member))>>::write(writer, value.*(field.member))), ...);
+            }, T::xmlFields());
+        return allSuccess;
+    }
+
+    static bool read(XmlSnapshotReader& reader, T& value)
+    {
+        uint64_t stored;
+        if (!reader.readFixed(stored, sizeof(stored)) || stored != signature())
+            return reader.fail();
+        bool allSuccess = true;
+        std::apply([&](const auto&... field)
+            {
+                ((allSuccess = allSuccess && XmlSnapshotTraits<std::decay_t<decltype(value.*(field.member))>>::read(reader, value.*(field.member))), ...);
+            }, T::xmlFields());
+        return allSuccess;
+    }
+
+    static uint64_t signature()
+    {
+        static const uint64_t hash = std::apply([](const auto&... field)
+            {
+                uint64_t result = xmlSnapshotHash(nullptr, 0);
+                ((result = hashField(result, field)), ...);
+                return result;
+            }, T::xmlFields());
+        return hash;
+    }
+
+private:
+    template <typename Field>
+    static uint64_t hashField(uint64_t seed, const Field& field)
+    {
+        using Member = std::decay_t<decltype(std::declval<T&>().*(field.member))>;
+        const char* type = typeid(Member).name();
+        seed = xmlSnapshotHash(field.name, std::strlen(field.name), seed);
+        return xmlSnapshotHash(type, std::strlen(type), seed);
+    }
+};
+
+template <typename T, typename Allocator>
+struct XmlSnapshotTraits<std::vector<T, Allocator>>
+{
+    static constexpr bool supported = XmlSnapshotTraits<T>::supported;
+
+    static bool write(XmlSnapshotWriter& writer, const std::vector<T, Allocator>& value)
+    {
+        writer.writeVarint(value.size());
+        bool allSuccess = true;
+        for (const auto& item : value)
+        {
+            if constexpr (std::is_same<T, bool>::value)
+                writer.write(static_cast<bool>(item));
+            else
+                allSuccess = allSuccess && XmlSnapshotTraits<T>::write(writer, item);
+        }
+        return allSuccess;
+    }
+
+    static bool read(XmlSnapshotReader& reader, std::vector<T, Allocator>& value)
+    {
+        size_t count;
+        if (!reader.readCount(count))
+            return false;
+        value.clear();
+        value.reserve(count);
+        for (size_t index = 0; index < count; ++index)
+        {
+            if constexpr (std::is_same<T, bool>::value)
+            {
+                bool item = false;
+                if (!reader.read(item))
+                    return false;
+                value.push_back(item);
+            }
+            else if (!XmlSnapshotTraits<T>::read(reader, value.emplace_back()))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+template <typename T>
+struct XmlSnapshotTraits<XmlPackedArray<T>> : XmlSnapshotTraits<std::vector<T>> {};
+
+template <typename Key, typename T, typename Compare, typename Allocator>
+struct XmlSnapshotTraits<std::map<Key, T, Compare, Allocator>>
+{
+    static constexpr bool supported = XmlSnapshotTraits<Key>::supported && XmlSnapshotTraits<T>::supported;
+
+    static bool write(XmlSnapshotWriter& writer, const std::map<Key, T, Compare, Allocator>& value)
+    {
+        writer.writeVarint(value.size());
+        bool allSuccess = true;
+        for (const auto& entry : value)
+        {
+            allSuccess = allSuccess && XmlSnapshotTraits<Key>::write(writer, entry.first)
+                && XmlSnapshotTraits<T>::write(writer, entry.second);
+        }
+        return allSuccess;
+    }
+
+    static bool read(XmlSnapshotReader& reader, std::map<Key, T, Compare, Allocator>& value)
+    {
+        size_t count;
+        if (!reader.readCount(count))
+            return false;
+        value.clear();
+        for (size_t index = 0; index < count; ++index)
+        {
+            Key key{};
+            if (!XmlSnapshotTraits<Key>::read(reader, key))
+                return false;
+            // Entries were written in map order, so each one goes to the end
+            auto entry = value.emplace_hint(value.end(), std::move(key), T());
+            if (!XmlSnapshotTraits<T>::read(reader, entry->second))
+                return false;
+        }
+        return true;
+    }
+};
+
+template <typename T>
+struct XmlSnapshotTraits<std::optional<T>>
+{
+    static constexpr bool supported = XmlSnapshotTraits<T>::supported;
+
+    static bool write(XmlSnapshotWriter& writer, const std::optional<T>& value)
+    {
+        writer.write(value.has_value());
+        return !value || XmlSnapshotTraits<T>::write(writer, *value);
+    }
+
+    static bool read(XmlSnapshotReader& reader, std::optional<T>& value)
+    {
+        bool present = false;
+        if (!reader.read(present))
+            return false;
+        if (!present)
+        {
+            value.reset();
+            return true;
+        }
+        if (!value)
+            value.emplace();
+        return XmlSnapshotTraits<T>::read(reader, *value);
+    }
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include "XmlSnapshot.h"
+
+class XMLSerializable;
+
+// Loads XMLSerializable trees from XML files through a binary snapshot kept beside each file.
+// The first load parses the XML and writes filename + suffix; later loads read the snapshot
+// directly as long as it was written for the file's current size, modification time and content
+// hash, and for the same field layouts. Anything else (missing, stale, corrupt or incompatible
+// snapshots) falls back to the XML, which also replaces the snapshot:
+//
+//     XmlSnapshotCache cache;
+//     if (!cache.load("config.xml", "Imput", imput))
+//         return false;
+//
+// The snapshot holds the values stored in the object tree (see XMLSerializable::writeSnapshot).
+// Reading it still hashes the XML file, which costs a fraction of parsing it.
+class XmlSnapshotCache
+{
+public:
+    enum class Source
+    {
+        None,       // Nothing was loaded
+        Snapshot,
+        Xml
+    };
+
+    explicit XmlSnapshotCache(std::string suffix = ".snapshot");
+
+    // Loads the rootName element of filename into object, from the snapshot when it is current.
+    // A snapshot is only written after the XML deserialized without errors; failing to write it is
+    // reported as IoFailed but does not fail the load.
+    bool load(const std::string& filename, const char* rootName, XMLSerializable& object);
+
+    // Writes the snapshot of object for the current contents of filename
+    bool store(const std::string& filename, const char* rootName, const XMLSerializable& object);
+
+    // Where the last load() took the object from
+    Source lastSource() const;
+    std::string snapshotPath(const std::string& filename) const;
+
+private:
+    struct SourceKey;
+
+    std::string m_suffix;
+    Source m_lastSource;
+    // Buffers kept between calls
+    XmlSnapshotWriter m_header;
+    XmlSnapshotWriter m_payload;
+
+    bool readSnapshot(const std::string& path, const SourceKey& key, const char* rootName, XMLSerializable& object);
+    bool writeSnapshot(const std::string& path, const SourceKey& key, const char* rootName, const XMLSerializable& object);
+};
@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include "tinyxml2.h"
+#include "XmlDiagnostics.h"
+#include "XmlNumericCodec.h"
+
+class XMLSerializable;
+
+// Writes XML straight to a file or a reusable in-memory buffer through a tinyxml2::XMLPrinter,
+// without holding a DOM for the whole output. Text is escaped by the printer; output is either
+// pretty-printed (same layout as XMLDocument::SaveFile) or compact.
+//
+//     XmlStreamWriter writer("output.xml");
+//     writer.openElement("PlatformSet");
+//     for (const auto& platform : platforms)
+//         writer.write("Platform", platform);
+//     writer.closeElement();
+//     bool saved = writer.close();
+class XmlStreamWriter
+{
+public:
+    // Writes to a file owned by the writer
+    explicit XmlStreamWriter(const std::string& filename, bool compact = false);
+    // Without it, a string literal would convert to bool and select the in-memory constructor
+    explicit XmlStreamWriter(const char* filename, bool compact = false);
+    // Writes to a file owned by the caller
+    explicit XmlStreamWriter(FILE* file, bool compact = false);
+    // Accumulates output in memory; see buffer() and clearBuffer()
+    explicit XmlStreamWriter(bool compact = false);
+    // Accumulates output in memory for content nested depth elements deep, to be inserted into
+    // another writer with writeRaw(); used to format parts of a document on several threads
+    XmlStreamWriter(bool compact, int depth);
+    ~XmlStreamWriter();
+
+    XmlStreamWriter(const XmlStreamWriter&) = delete;
+    XmlStreamWriter& operator=(const XmlStreamWriter&) = delete;
+
+    // Flushes the output and checks it for write errors, closing the file if the writer owns it.
+    // Returns false, reporting IoFailed, if any output could not be written; a file left open is
+    // closed by the destructor, which cannot report the result.
+    bool close();
+
+    bool isOpen() const;
+    bool isCompact() const;
+    // Number of elements currently open, including the depth given at construction
+    int depth() const;
+
+    bool openElement(const char* name);
+    bool closeElement();
+
+    // Writes <name>value</name>, converting values the same way as XmlElementWrapper::operator<<
+    bool write(const char* name, const std::string& value);
+    bool write(const char* name, const char* value);
+    bool write(const char* name, int value);
+    bool write(const char* name, unsigned int value);
+    bool write(const char* name, int64_t value);
+    bool write(const char* name, uint64_t value);
+    bool write(const char* name, bool value);
+    bool write(const char* name, double value);
+    bool write(const char* name, float value);
+
+    // Writes <name>...</name> with the content produced by serializable.serializeStream()
+    bool write(const char* name, const XMLSerializable& serializable);
+
+    // Copies an existing DOM subtree to the output
+    bool write(const tinyxml2::XMLElement* element);
+
+    // Inserts output of a writer constructed with XmlStreamWriter(isCompact(), depth()) at the
+    // current position, giving the same bytes as writing its content here directly
+    bool writeRaw(const char* data, size_t size);
+
+    // Buffered output (only for writers constructed without a file)
+    const char* buffer() const;
+    size_t size() const;
+    void clearBuffer();
+
+    // Reusable document for serializers that only know how to build DOM nodes. The returned
+    // element is valid until writeScratch() is called.
+    tinyxml2::XMLElement* scratchElement();
+    // Writes the attributes and children of the scratch element into the open element, then
+    // releases the scratch nodes while keeping the document's memory pools
+    void writeScratch();
+
+    tinyxml2::XMLPrinter& printer();
+
+private:
+    // Gives access to the printer's raw output
+    class Printer : public tinyxml2::XMLPrinter
+    {
+    public:
+        using tinyxml2::XMLPrinter::XMLPrinter;
+
+        void writeRaw(const char* data, size_t size)
+        {
+            SealElementIfJustOpened();
+            Write(data, size);
+        }
+    };
+
+    FILE* m_file;
+    std::string m_filename;
+    bool m_ownsFile;
+    bool m_compact;
+    int m_depth;
+    int m_baseDepth;
+    Printer m_printer;
+    tinyxml2::XMLDocument m_scratch;
+
+    bool writeText(const char* name, const char* text);
+
+    template <typename T>
+    bool writeNumber(const char* name, T value)
+    {
+        char buffer[XmlNumericCodec::BufferSize];
+        if (!XmlNumericCodec::format(buffer, sizeof(buffer), value))
+        {
+            XmlDiagnostics::report(XmlErrorCode::FormatFailed, nullptr, name, "Failed to format value for element");
+            return false;
+        }
+        return writeText(name, buffer);
+    }
+};
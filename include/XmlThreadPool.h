@@ -0,0 +1,44 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for the parallel (de)serialization helpers. The calling thread takes
+// part in the work, so nested calls from inside a task cannot deadlock.
+class XmlThreadPool
+{
+public:
+    // threads = 0 uses one worker per hardware thread, minus the caller
+    explicit XmlThreadPool(size_t threads = 0);
+    ~XmlThreadPool();
+
+    XmlThreadPool(const XmlThreadPool&) = delete;
+    XmlThreadPool& operator=(const XmlThreadPool&) = delete;
+
+    // Number of threads working on a run() call, including the caller
+    size_t concurrency() const;
+
+    // Calls task(index) for every index in [0, count) and returns when all calls have finished.
+    // Indices are handed out dynamically, so uneven tasks balance across threads. If tasks throw,
+    // the exception of the lowest index is rethrown after the others have finished.
+    void run(size_t count, const std::function<void(size_t)>& task);
+
+    // Queues a job for a worker thread and returns immediately
+    void post(std::function<void()> job);
+
+    // Process-wide pool, created on first use
+    static XmlThreadPool& shared();
+
+private:
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stop;
+
+    void work();
+};
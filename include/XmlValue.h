@@ -0,0 +1,108 @@
+#pragma once
+#include <any>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <variant>
+#include "XmlValueTraits.h"
+
+// Storage for one XMLSerializable field value. The scalar types converted by the
+// XmlElementWrapper operators are held inline in a std::variant and reached by alternative index,
+// without RTTI and without a heap allocation for short std::string values. Nested objects and
+// containers, whose set is open, are held in the std::any alternative.
+class XmlValue
+{
+public:
+    using Storage = std::variant<std::monostate, std::string, int, unsigned int, int64_t, uint64_t, bool, double, float, std::any>;
+
+    XmlValue() = default;
+
+    template <typename T, typename = typename std::enable_if<!std::is_same<typename std::decay<T>::type, XmlValue>::value>::type>
+    XmlValue(T&& value)
+    {
+        emplace<typename std::decay<T>::type>(std::forward<T>(value));
+    }
+
+    // The value if it is a T, otherwise nullptr
+    template <typename T>
+    T* get() noexcept
+    {
+        if constexpr (XmlIsScalar<T>::value)
+        {
+            return std::get_if<T>(&m_storage);
+        }
+        else
+        {
+            std::any* other = std::get_if<std::any>(&m_storage);
+            return other ? std::any_cast<T>(other) : nullptr;
+        }
+    }
+
+    template <typename T>
+    const T* get() const noexcept
+    {
+        return const_cast<XmlValue*>(this)->get<T>();
+    }
+
+    template <typename T>
+    bool holds() const noexcept
+    {
+        return get<T>() != nullptr;
+    }
+
+    // Replaces the value with a T constructed from args
+    template <typename T, typename... Args>
+    T& emplace(Args&&... args)
+    {
+        if constexpr (XmlIsScalar<T>::value)
+            return m_storage.template emplace<T>(std::forward<Args>(args)...);
+        else
+            return m_storage.template emplace<std::any>().template emplace<T>(std::forward<Args>(args)...);
+    }
+
+    // Assigns to a stored T in place, reusing its storage (string or vector capacity)
+    template <typename T>
+    void assign(const T& value)
+    {
+        if (T* stored = get<T>())
+            *stored = value;
+        else
+            emplace<T>(value);
+    }
+
+    bool empty() const noexcept
+    {
+        return std::holds_alternative<std::monostate>(m_storage);
+    }
+
+    // Type of the held value; typeid(void) when empty
+    const std::type_info& type() const noexcept
+    {
+        return std::visit([](const auto& value) -> const std::type_info&
+            {
+                using Held = typename std::decay<decltype(value)>::type;
+                if constexpr (std::is_same<Held, std::monostate>::value)
+                    return typeid(void);
+                else if constexpr (std::is_same<Held, std::any>::value)
+                    return value.type();
+                else
+                    return typeid(Held);
+            }, m_storage);
+    }
+
+    // Calls visitor with the held scalar, the std::any holding another type, or std::monostate
+    template <typename Visitor>
+    decltype(auto) visit(Visitor&& visitor) const
+    {
+        return std::visit(std::forward<Visitor>(visitor), m_storage);
+    }
+
+    template <typename Visitor>
+    decltype(auto) visit(Visitor&& visitor)
+    {
+        return std::visit(std::forward<Visitor>(visitor), m_storage);
+    }
+
+private:
+    Storage m_storage;
+};
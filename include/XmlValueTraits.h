@@ -0,0 +1,433 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "tinyxml2.h"
+#include "XmlDiagnostics.h"
+#include "XmlElementWrapper.h"
+
+class XMLSerializable;
+
+// Element name used for container items unless configured otherwise
+constexpr const char* XmlDefaultItemName = "Item";
+// Child elements of a map item
+constexpr const char* XmlMapKeyName = "Key";
+constexpr const char* XmlMapValueName = "Value";
+
+// True for structs declaring their fields with XML_FIELDS (see XmlBinding.h)
+template <typename T, typename = void>
+struct XmlHasFields : std::false_type {};
+
+template <typename T>
+struct XmlHasFields<T, std::void_t<decltype(T::xmlFields())>> : std::true_type {};
+
+// Class declaring a (de)serialization member; only used in decltype
+template <typename C>
+C* xmlMemberOwner(bool (C::*)(tinyxml2::XMLElement*));
+template <typename C>
+C* xmlMemberOwner(bool (C::*)(tinyxml2::XMLElement*) const);
+
+// True if XMLSerializable subclass T, or a class between them, overrides deserialize, serialize or
+// update. An element read or written by custom code is not described by the stored fields, so it
+// cannot be bound lazily or updated field by field.
+template <typename T>
+struct XmlCustomDeserialize : std::integral_constant<bool,
+    !std::is_same<decltype(xmlMemberOwner(&T::deserialize)), XMLSerializable*>::value> {};
+
+template <typename T>
+struct XmlCustomSerialize : std::integral_constant<bool,
+    !std::is_same<decltype(xmlMemberOwner(&T::serialize)), XMLSerializable*>::value> {};
+
+template <typename T>
+struct XmlCustomUpdate : std::integral_constant<bool,
+    !std::is_same<decltype(xmlMemberOwner(&T::update)), XMLSerializable*>::value> {};
+
+// Types converted by the XmlElementWrapper operators
+template <typename T>
+struct XmlIsScalar : std::integral_constant<bool,
+    std::is_same<T, std::string>::value || std::is_same<T, int>::value || std::is_same<T, unsigned int>::value
+    || std::is_same<T, int64_t>::value || std::is_same<T, uint64_t>::value || std::is_same<T, bool>::value
+    || std::is_same<T, double>::value || std::is_same<T, float>::value> {};
+
+template <typename T>
+struct XmlIsOptional : std::false_type {};
+
+template <typename T>
+struct XmlIsOptional<std::optional<T>> : std::true_type {};
+
+// Types that can be stored as an attribute instead of a child element: scalars and optional scalars
+template <typename T>
+struct XmlIsAttributeValue : XmlIsScalar<T> {};
+
+template <typename T>
+struct XmlIsAttributeValue<std::optional<T>> : XmlIsScalar<T> {};
+
+// Reads and writes a value of type T as the content of an existing element. Supported are the
+// scalar types, XMLSerializable subclasses, structs bound with XML_FIELDS, and std::vector,
+// std::map and std::optional of supported types. Containers write one itemName element per item.
+template <typename T, typename = void>
+struct XmlValueTraits
+{
+    static constexpr bool supported = false;
+};
+
+template <typename T>
+bool xmlWriteChild(tinyxml2::XMLElement* parent, const char* name, const T& value, const char* itemName = XmlDefaultItemName);
+
+template <typename T>
+bool xmlReadChild(tinyxml2::XMLElement* parent, const char* name, T& value, const char* itemName = XmlDefaultItemName);
+
+template <typename T>
+bool xmlUpdateChild(tinyxml2::XMLElement* parent, const char* name, T& value, const char* itemName = XmlDefaultItemName);
+
+template <typename T>
+bool xmlWriteAttribute(tinyxml2::XMLElement* element, const char* name, const T& value);
+
+template <typename T>
+bool xmlReadAttribute(tinyxml2::XMLElement* element, const char* name, T& value);
+
+template <typename T>
+struct XmlValueTraits<T, typename std::enable_if<XmlIsScalar<T>::value>::type>
+{
+    static constexpr bool supported = true;
+
+    static bool write(tinyxml2::XMLElement* element, const T& value, const char*)
+    {
+        XmlElementWrapper wrapper(element);
+        return wrapper << value;
+    }
+
+    static bool read(tinyxml2::XMLElement* element, T& value, const char*)
+    {
+        XmlElementWrapper wrapper(element);
+        return wrapper >> value;
+    }
+};
+
+template <typename T>
+struct XmlValueTraits<T, typename std::enable_if<std::is_base_of<XMLSerializable, T>::value && !XmlHasFields<T>::value>::type>
+{
+    static constexpr bool supported = true;
+
+    static bool write(tinyxml2::XMLElement* element, const T& value, const char*) { return value.serialize(element); }
+    static bool read(tinyxml2::XMLElement* element, T& value, const char*) { return value.deserialize(element); }
+};
+
+template <typename T>
+struct XmlValueTraits<T, typename std::enable_if<XmlHasFields<T>::value>::type>
+{
+    static constexpr bool supported = true;
+
+    static bool write(tinyxml2::XMLElement* element, const T& value, const char*)
+    {
+        bool allSuccess = true;
+        std::apply([&](const auto&... field)
+            {
+                ((allSuccess &= writeField(element, field, value)), ...);
+            }, T::xmlFields());
+        return allSuccess;
+    }
+
+    static bool read(tinyxml2::XMLElement* element, T& value, const char*)
+    {
+        bool allSuccess = true;
+        std::apply([&](const auto&... field)
+            {
+                ((allSuccess &= readField(element, field, value)), ...);
+            }, T::xmlFields());
+        return allSuccess;
+    }
+
+private:
+    template <typename Field>
+    static bool writeField(tinyxml2::XMLElement* element, const Field& field, const T& value)
+    {
+        if constexpr (Field::attribute)
+            return xmlWriteAttribute(element, field.name, value.*(field.member));
+        else
+            return xmlWriteChild(element, field.name, value.*(field.member));
+    }
+
+    template <typename Field>
+    static bool readField(tinyxml2::XMLElement* element, const Field& field, T& value)
+    {
+        if constexpr (Field::attribute)
+            return xmlReadAttribute(element, field.name, value.*(field.member));
+        else
+            return xmlReadChild(element, field.name, value.*(field.member));
+    }
+};
+
+template <typename T, typename Allocator>
+struct XmlValueTraits<std::vector<T, Allocator>>
+{
+    static constexpr bool supported = XmlValueTraits<T>::supported;
+
+    static bool write(tinyxml2::XMLElement* element, const std::vector<T, Allocator>& value, const char* itemName)
+    {
+        bool allSuccess = true;
+        for (const auto& item : value)
+        {
+            tinyxml2::XMLElement* child = element->GetDocument()->NewElement(itemName);
+            element->InsertEndChild(child);
+            allSuccess &= XmlValueTraits<T>::write(child, item, itemName);
+        }
+        return allSuccess;
+    }
+
+    // Counts the items first so the vector is allocated once, then reads each item in place
+    static bool read(tinyxml2::XMLElement* element, std::vector<T, Allocator>& value, const char* itemName)
+    {
+        size_t count = 0;
+        for (tinyxml2::XMLElement* child = element->FirstChildElement(itemName); child; child = child->NextSiblingElement(itemName))
+            ++count;
+
+        value.clear();
+        value.reserve(count);
+        bool allSuccess = true;
+        for (tinyxml2::XMLElement* child = element->FirstChildElement(itemName); child; child = child->NextSiblingElement(itemName))
+        {
+            if constexpr (std::is_same<T, bool>::value)
+            {
+                bool item = false;
+                allSuccess &= XmlValueTraits<bool>::read(child, item, itemName);
+                value.push_back(item);
+            }
+            else
+            {
+                allSuccess &= XmlValueTraits<T>::read(child, value.emplace_back(), itemName);
+            }
+        }
+        return allSuccess;
+    }
+};
+
+template <typename Key, typename T, typename Compare, typename Allocator>
+struct XmlValueTraits<std::map<Key, T, Compare, Allocator>>
+{
+    static constexpr bool supported = XmlValueTraits<Key>::supported && XmlValueTraits<T>::supported;
+
+    // <itemName><Key>...</Key><Value>...</Value></itemName> per entry
+    static bool write(tinyxml2::XMLElement* element, const std::map<Key, T, Compare, Allocator>& value, const char* itemName)
+    {
+        bool allSuccess = true;
+        for (const auto& entry : value)
+        {
+            tinyxml2::XMLElement* child = element->GetDocument()->NewElement(itemName);
+            element->InsertEndChild(child);
+            allSuccess &= xmlWriteChild(child, XmlMapKeyName, entry.first, itemName);
+            allSuccess &= xmlWriteChild(child, XmlMapValueName, entry.second, itemName);
+        }
+        return allSuccess;
+    }
+
+    static bool read(tinyxml2::XMLElement* element, std::map<Key, T, Compare, Allocator>& value, const char* itemName)
+    {
+        value.clear();
+        bool allSuccess = true;
+        for (tinyxml2::XMLElement* child = element->FirstChildElement(itemName); child; child = child->NextSiblingElement(itemName))
+        {
+            Key key{};
+            if (!xmlReadChild(child, XmlMapKeyName, key, itemName))
+            {
+                allSuccess = false;
+                continue;
+            }
+            allSuccess &= xmlReadChild(child, XmlMapValueName, value[std::move(key)], itemName);
+        }
+        return allSuccess;
+    }
+};
+
+template <typename T>
+struct XmlValueTraits<XmlPackedArray<T>>
+{
+    static constexpr bool supported = true;
+
+    static bool write(tinyxml2::XMLElement* element, const XmlPackedArray<T>& value, const char*)
+    {
+        XmlElementWrapper wrapper(element);
+        return wrapper << value;
+    }
+
+    static bool read(tinyxml2::XMLElement* element, XmlPackedArray<T>& value, const char*)
+    {
+        XmlElementWrapper wrapper(element);
+        return wrapper >> value;
+    }
+};
+
+template <typename T>
+struct XmlValueTraits<std::optional<T>>
+{
+    static constexpr bool supported = XmlValueTraits<T>::supported;
+
+    static bool write(tinyxml2::XMLElement* element, const std::optional<T>& value, const char* itemName)
+    {
+        return !value || XmlValueTraits<T>::write(element, *value, itemName);
+    }
+
+    static bool read(tinyxml2::XMLElement* element, std::optional<T>& value, const char* itemName)
+    {
+        if (!value)
+            value.emplace();
+        return XmlValueTraits<T>::read(element, *value, itemName);
+    }
+};
+
+// Writes value as the child element name of parent. Empty optionals are omitted.
+template <typename T>
+bool xmlWriteChild(tinyxml2::XMLElement* parent, const char* name, const T& value, const char* itemName)
+{
+    static_assert(XmlValueTraits<T>::supported, "Type is not supported for XML serialization");
+    if constexpr (XmlIsOptional<T>::value)
+    {
+        if (!value)
+            return true;
+    }
+    XmlElementWrapper wrapper(parent, name, true);  // For serialization
+    return wrapper.getElement() && XmlValueTraits<T>::write(wrapper.getElement(), value, itemName);
+}
+
+// Reads value from the child element name of parent. A missing optional is reset without error.
+template <typename T>
+bool xmlReadChild(tinyxml2::XMLElement* parent, const char* name, T& value, const char* itemName)
+{
+    static_assert(XmlValueTraits<T>::supported, "Type is not supported for XML deserialization");
+    if constexpr (XmlIsOptional<T>::value)
+    {
+        if (parent && !parent->FirstChildElement(name))
+        {
+            value.reset();
+            return true;
+        }
+    }
+    XmlElementWrapper wrapper(parent, name, false);  // For deserialization
+    return wrapper.getElement() && XmlValueTraits<T>::read(wrapper.getElement(), value, itemName);
+}
+
+// Rewrites the existing child element name of parent to hold value (see XMLSerializable::update).
+// Scalar text is replaced in place and XMLSerializable objects update their dirty fields, except
+// those with a custom serialize() and no update() of their own; other values rebuild the
+// element's content. A missing child is created and an empty optional removed.
+template <typename T>
+bool xmlUpdateChild(tinyxml2::XMLElement* parent, const char* name, T& value, const char* itemName)
+{
+    static_assert(XmlValueTraits<T>::supported, "Type is not supported for XML serialization");
+    tinyxml2::XMLElement* child = parent->FirstChildElement(name);
+    if constexpr (XmlIsOptional<T>::value)
+    {
+        if (!value)
+        {
+            if (child)
+                parent->DeleteChild(child);
+            return true;
+        }
+        return xmlUpdateChild(parent, name, *value, itemName);
+    }
+    else
+    {
+        if (!child)
+            return xmlWriteChild(parent, name, value, itemName);
+        if constexpr (std::is_base_of<XMLSerializable, T>::value && !XmlHasFields<T>::value)
+        {
+            // Objects with a custom serialize() are rebuilt through it, unless they also provide
+            // their own update()
+            if constexpr (XmlCustomSerialize<T>::value && !XmlCustomUpdate<T>::value)
+            {
+                child->DeleteChildren();
+                bool success = value.serialize(child);
+                if (success)
+                    value.markClean();
+                return success;
+            }
+            else
+            {
+                return value.update(child);
+            }
+        }
+        else
+        {
+            if constexpr (!XmlIsScalar<T>::value)
+                child->DeleteChildren();
+            return XmlValueTraits<T>::write(child, value, itemName);
+        }
+    }
+}
+
+// Writes value as the attribute name of element, replacing an existing value. An empty optional
+// removes the attribute.
+template <typename T>
+bool xmlWriteAttribute(tinyxml2::XMLElement* element, const char* name, const T& value)
+{
+    static_assert(XmlIsAttributeValue<T>::value, "Only scalars and optional scalars can be stored as attributes");
+    if constexpr (XmlIsOptional<T>::value)
+    {
+        if (!value)
+        {
+            if (element)
+                element->DeleteAttribute(name);
+            return true;
+        }
+        return xmlWriteAttribute(element, name, *value);
+    }
+    else
+    {
+        XmlAttributeWrapper wrapper(element, name);
+        return wrapper << value;
+    }
+}
+
+// Reads value from the attribute name of element. A missing optional is reset without error.
+template <typename T>
+bool xmlReadAttribute(tinyxml2::XMLElement* element, const char* name, T& value)
+{
+    static_assert(XmlIsAttributeValue<T>::value, "Only scalars and optional scalars can be stored as attributes");
+    if constexpr (XmlIsOptional<T>::value)
+    {
+        if (element && !element->FindAttribute(name))
+        {
+            value.reset();
+            return true;
+        }
+        if (!value)
+            value.emplace();
+        return xmlReadAttribute(element, name, *value);
+    }
+    else
+    {
+        XmlAttributeWrapper wrapper(element, name);
+        return wrapper >> value;
+    }
+}
+
+// External helper functions for attributes, mixing freely with the element helpers
+template <typename T, typename std::enable_if<XmlIsAttributeValue<T>::value, int>::type = 0>
+bool serializeAttribute(tinyxml2::XMLElement* element, const char* name, const T& value)
+{
+    return xmlWriteAttribute(element, name, value);
+}
+
+template <typename T, typename std::enable_if<XmlIsAttributeValue<T>::value, int>::type = 0>
+bool deserializeAttribute(tinyxml2::XMLElement* element, const char* name, T& value)
+{
+    return xmlReadAttribute(element, name, value);
+}
+
+// External helper functions for containers, bound structs and XMLSerializable objects, matching
+// the scalar helpers in XmlElementWrapper.h
+template <typename T, typename std::enable_if<XmlValueTraits<T>::supported && !XmlIsScalar<T>::value, int>::type = 0>
+bool serialize(tinyxml2::XMLElement* element, const char* name, const T& value, const char* itemName = XmlDefaultItemName)
+{
+    return xmlWriteChild(element, name, value, itemName);
+}
+
+template <typename T, typename std::enable_if<XmlValueTraits<T>::supported && !XmlIsScalar<T>::value, int>::type = 0>
+bool deserialize(tinyxml2::XMLElement* element, const char* name, T& value, const char* itemName = XmlDefaultItemName)
+{
+    return xmlReadChild(element, name, value, itemName);
+}
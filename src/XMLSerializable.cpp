@@ -1,106 +1,465 @@
 #include "XMLSerializable.h"
+#include "XmlMetrics.h"
+#include "XmlStreamWriter.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Failures are reported under the field key, which the getters and error hooks use; the
+    // element or attribute name is added when it differs
+    std::string missingReason(const char* what, const XmlFieldLayout::Field& field, const char* name)
+    {
+        if (field.key == name)
+            return std::string(what) + " missing or invalid";
+        return std::string(what) + " '" + name + "' missing or invalid";
+    }
+}
+
+XMLSerializable::XMLSerializable(std::shared_ptr<const XmlFieldLayout> layout)
+    : m_layout(std::move(layout))
+{
+    if (m_layout)
+    {
+        m_values.reserve(m_layout->size());
+        for (size_t slot = 0; slot < m_layout->size(); ++slot)
+            m_values.push_back(m_layout->field(slot).defaultValue);
+    }
+}
+
+XMLSerializable::XMLSerializable(const XMLSerializable& other)
+    : m_layout(other.m_layout), m_values(other.m_values), m_ownsLayout(other.m_ownsLayout),
+      m_source(other.m_source), m_pending(other.m_pending), m_pendingCount(other.m_pendingCount)
+{
+}
+
+XMLSerializable& XMLSerializable::operator=(const XMLSerializable& other)
+{
+    if (this != &other)
+    {
+        m_layout = other.m_layout;
+        m_values = other.m_values;
+        m_ownsLayout = other.m_ownsLayout;
+        m_allDirty = true;
+        m_dirty.clear();
+        m_boundElement = nullptr;
+        m_source = other.m_source;
+        m_pending = other.m_pending;
+        m_pendingCount = other.m_pendingCount;
+    }
+    return *this;
+}
 
 bool XMLSerializable::serialize(tinyxml2::XMLElement* element) const
 {
+    XmlMetricsScope metrics(typeid(*this), XmlMetricsPhase::Serialize);
+    if (!m_layout)
+        return true;
+    loadAll();
+
+    XmlDiagnosticScope scope(element);
     bool allSuccess = true;
-    for (const auto& data : m_data)
-    {
-        XmlElementWrapper wrapper(element, data.first.c_str(), true);  // For serialization
-        bool success = false;
-        if (data.second.type() == typeid(std::string))
-            success = wrapper << std::any_cast<std::string>(data.second);
-        else if (data.second.type() == typeid(int))
-            success = wrapper << std::any_cast<int>(data.second);
-        else if (data.second.type() == typeid(unsigned int))
-            success = wrapper << std::any_cast<unsigned int>(data.second);
-        else if (data.second.type() == typeid(int64_t))
-            success = wrapper << std::any_cast<int64_t>(data.second);
-        else if (data.second.type() == typeid(uint64_t))
-            success = wrapper << std::any_cast<uint64_t>(data.second);
-        else if (data.second.type() == typeid(bool))
-            success = wrapper << std::any_cast<bool>(data.second);
-        else if (data.second.type() == typeid(double))
-            success = wrapper << std::any_cast<double>(data.second);
-        else if (data.second.type() == typeid(float))
-            success = wrapper << std::any_cast<float>(data.second);
-
-        if (!success)
+    for (size_t slot : m_layout->byKey())
+    {
+        const XmlFieldLayout::Field& field = m_layout->field(slot);
+        if (!field.ops)
         {
-            onSerializeError(data.first, "Failed to write value to element");
+            XmlMetrics::record(XmlMetricEvent::Failure, field.key.c_str());
+            onSerializeError(field.key, "Unsupported value type");
             allSuccess = false;
         }
+        else if (m_layout->isAttribute(slot)
+            ? !field.ops->writeAttribute(element, m_layout->elementName(slot), m_values[slot])
+            : !field.ops->write(element, m_layout->elementName(slot), m_values[slot], m_layout->itemName(slot)))
+        {
+            XmlMetrics::record(XmlMetricEvent::Failure, field.key.c_str());
+            onSerializeError(field.key, "Failed to write value to element");
+            allSuccess = false;
+        }
+        else
+        {
+            XmlMetrics::record(XmlMetricEvent::Conversion, field.key.c_str());
+        }
     }
     return allSuccess;
 }
 
+bool XMLSerializable::serializeStream(XmlStreamWriter& writer) const
+{
+    bool success = serialize(writer.scratchElement());
+    writer.writeScratch();
+    return success;
+}
+
+bool XMLSerializable::writeSnapshot(XmlSnapshotWriter& writer) const
+{
+    writer.writeFixed(m_layout ? m_layout->signature() : 0, sizeof(uint64_t));
+    if (!m_layout)
+        return true;
+    loadAll();
+
+    for (size_t slot : m_layout->byKey())
+    {
+        const XmlFieldLayout::Field& field = m_layout->field(slot);
+        if (!field.ops || !field.ops->writeSnapshot(writer, m_values[slot]))
+        {
+            onSerializeError(field.key, "Failed to write snapshot value");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool XMLSerializable::readSnapshot(XmlSnapshotReader& reader)
+{
+    uint64_t signature;
+    if (!reader.readFixed(signature, sizeof(signature)) || signature != (m_layout ? m_layout->signature() : 0))
+        return reader.fail();
+    if (!m_layout)
+        return true;
+
+    m_source = nullptr;
+    m_pending.clear();
+    for (size_t slot : m_layout->byKey())
+    {
+        const XmlFieldOps* ops = m_layout->field(slot).ops;
+        if (!ops || !ops->readSnapshot(reader, m_values[slot]))
+            return reader.fail();
+    }
+    return true;
+}
+
 bool XMLSerializable::deserialize(tinyxml2::XMLElement* element)
 {
+    XmlMetricsScope metrics(typeid(*this), XmlMetricsPhase::Deserialize);
+    m_source = nullptr;
+    m_pending.clear();
+    if (!element)
+    {
+        XmlDiagnostics::report(XmlErrorCode::NullElement, nullptr, nullptr, "Parent element is null");
+        if (!m_layout)
+            return true;
+        for (size_t slot : m_layout->byKey())
+            onDeserializeError(m_layout->field(slot).key, missingReason("Element", m_layout->field(slot), m_layout->elementName(slot)), DeserializeIssue::MissingOrInvalid);
+        return m_layout->empty();
+    }
+    if (!m_layout)
+    {
+        markClean();
+        return true;
+    }
+
+    XmlDiagnosticScope scope(element);
+
+    // The layout keeps its fields sorted by element name, so each child element is matched with a
+    // binary search instead of a FirstChildElement scan per key
+    const XmlFieldLayout& layout = *m_layout;
+    const std::vector<size_t>& byElement = layout.byElement();
+    std::vector<bool> found(layout.size(), false);
+
     bool allSuccess = true;
-    for (auto& [key, value] : m_data)
+    for (tinyxml2::XMLElement* child = element->FirstChildElement(); child; child = child->NextSiblingElement())
     {
-        XmlElementWrapper wrapper(element, key.c_str(), false);  // For deserialization
-        bool success = false;
-        if (value.type() == typeid(std::string))
+        const char* name = child->Name();
+        auto entry = std::lower_bound(byElement.begin(), byElement.end(), name,
+            [&layout](size_t slot, const char* target) { return std::strcmp(layout.elementName(slot), target) < 0; });
+        // Attribute fields do not claim child elements of the same name
+        if (entry == byElement.end() || std::strcmp(layout.elementName(*entry), name) != 0 || layout.isAttribute(*entry))
         {
-            std::string temp;
-            success = wrapper >> temp;
-            if (success) value = temp;
-            else onDeserializeError(key, "Element missing or invalid");
+            XmlMetrics::record(XmlMetricEvent::Lookup, name);
+            XmlMetrics::record(XmlMetricEvent::Miss, name);
+            onDeserializeError(name, "Unexpected element (ignored)", DeserializeIssue::Unexpected);
+            continue;
         }
-        else if (value.type() == typeid(int))
+
+        size_t slot = *entry;
+        if (found[slot])
         {
-            int temp;
-            success = wrapper >> temp;
-            if (success) value = temp;
-            else onDeserializeError(key, "Element missing or invalid");
+            onDeserializeError(name, "Duplicate element (ignored)", DeserializeIssue::Duplicate);
+            continue;
+        }
+        found[slot] = true;
+
+        // Counters use the field key, which serialize() reports too
+        const XmlFieldLayout::Field& field = layout.field(slot);
+        XmlMetrics::record(XmlMetricEvent::Lookup, field.key.c_str());
+        if (!field.ops || !field.ops->read(child, m_values[slot], layout.itemName(slot)))
+        {
+            XmlMetrics::record(XmlMetricEvent::Failure, field.key.c_str());
+            onDeserializeError(field.key, missingReason("Element", field, name), DeserializeIssue::MissingOrInvalid);
+            allSuccess = false;
         }
-        else if (value.type() == typeid(unsigned int))
+        else
+        {
+            XmlMetrics::record(XmlMetricEvent::Conversion, field.key.c_str());
+        }
+    }
+
+    for (size_t slot : byElement)
+    {
+        if (layout.isAttribute(slot))
         {
-            unsigned int temp;
-            success = wrapper >> temp;
-            if (success) value = temp;
-            else onDeserializeError(key, "Element missing or invalid");
+            allSuccess &= readAttribute(element, slot);
+            continue;
         }
-        else if (value.type() == typeid(int64_t))
+        if (found[slot])
+            continue;
+        // Counted as a lookup that missed, whether or not the field is optional
+        const XmlFieldLayout::Field& field = layout.field(slot);
+        XmlMetrics::record(XmlMetricEvent::Lookup, field.key.c_str());
+        XmlMetrics::record(XmlMetricEvent::Miss, field.key.c_str());
+        if (!(field.ops && field.ops->readMissing(m_values[slot])))
         {
-            int64_t temp;
-            success = wrapper >> temp;
-            if (success) value = temp;
-            else onDeserializeError(key, "Element missing or invalid");
+            XmlMetrics::record(XmlMetricEvent::Failure, field.key.c_str());
+            onDeserializeError(field.key, missingReason("Element", field, layout.elementName(slot)), DeserializeIssue::MissingOrInvalid);
+            allSuccess = false;
         }
-        else if (value.type() == typeid(uint64_t))
+    }
+    markClean();
+    return allSuccess;
+}
+
+bool XMLSerializable::deserializeLazy(tinyxml2::XMLElement* element)
+{
+    m_source = nullptr;
+    m_pending.clear();
+    m_pendingCount = 0;
+    if (!element)
+    {
+        XmlDiagnostics::report(XmlErrorCode::NullElement, nullptr, nullptr, "Parent element is null");
+        return false;
+    }
+    markClean();
+    if (!m_layout || m_layout->empty())
+        return true;
+
+    m_source = element;
+    m_pending.assign(m_layout->size(), true);
+    m_pendingCount = m_layout->size();
+    return true;
+}
+
+bool XMLSerializable::materialize()
+{
+    bool success = loadAll();
+    m_source = nullptr;
+
+    // Nested objects read so far are still bound to the document
+    if (m_layout)
+    {
+        for (size_t slot = 0; slot < m_layout->size(); ++slot)
         {
-            uint64_t temp;
-            success = wrapper >> temp;
-            if (success) value = temp;
-            else onDeserializeError(key, "Element missing or invalid");
+            const XmlFieldOps* ops = m_layout->field(slot).ops;
+            if (XMLSerializable* nested = ops ? ops->object(m_values[slot]) : nullptr)
+                success &= nested->materialize();
         }
-        else if (value.type() == typeid(bool))
+    }
+    return success;
+}
+
+bool XMLSerializable::isMaterialized() const
+{
+    return m_pending.empty();
+}
+
+bool XMLSerializable::loadPending(size_t slot) const
+{
+    clearPending(slot);
+
+    const XmlFieldLayout::Field& field = m_layout->field(slot);
+    const char* name = m_layout->elementName(slot);
+    XmlMetricsScope metrics(typeid(*this));
+    XmlDiagnosticScope scope(m_source);
+    if (m_layout->isAttribute(slot))
+        return readAttribute(m_source, slot);
+    XmlMetrics::record(XmlMetricEvent::Lookup, field.key.c_str());
+
+    tinyxml2::XMLElement* child = m_source->FirstChildElement(name);
+    bool success;
+    if (child)
+    {
+        success = field.ops && field.ops->readLazy(child, m_values[slot], m_layout->itemName(slot));
+    }
+    else
+    {
+        XmlMetrics::record(XmlMetricEvent::Miss, field.key.c_str());
+        success = field.ops && field.ops->readMissing(m_values[slot]);
+    }
+
+    if (!success)
+    {
+        XmlMetrics::record(XmlMetricEvent::Failure, field.key.c_str());
+        onDeserializeError(field.key, missingReason("Element", field, name), DeserializeIssue::MissingOrInvalid);
+    }
+    else if (child)
+    {
+        XmlMetrics::record(XmlMetricEvent::Conversion, field.key.c_str());
+    }
+    return success;
+}
+
+bool XMLSerializable::readAttribute(tinyxml2::XMLElement* element, size_t slot) const
+{
+    const XmlFieldLayout::Field& field = m_layout->field(slot);
+    const char* name = m_layout->elementName(slot);
+    XmlMetrics::record(XmlMetricEvent::Lookup, field.key.c_str());
+    bool present = element->FindAttribute(name) != nullptr;
+    if (!present)
+        XmlMetrics::record(XmlMetricEvent::Miss, field.key.c_str());
+
+    if (!field.ops->readAttribute(element, name, m_values[slot]))
+    {
+        XmlMetrics::record(XmlMetricEvent::Failure, field.key.c_str());
+        onDeserializeError(field.key, missingReason("Attribute", field, name), DeserializeIssue::MissingOrInvalid);
+        return false;
+    }
+    if (present)
+        XmlMetrics::record(XmlMetricEvent::Conversion, field.key.c_str());
+    return true;
+}
+
+bool XMLSerializable::loadAll() const
+{
+    bool allSuccess = true;
+    for (size_t slot = 0; slot < m_pending.size(); ++slot)
+    {
+        if (m_pending[slot])
+            allSuccess &= loadPending(slot);
+    }
+    return allSuccess;
+}
+
+void XMLSerializable::clearPending(size_t slot) const
+{
+    m_pending[slot] = false;
+    if (--m_pendingCount == 0)
+        m_pending.clear();
+}
+
+bool XMLSerializable::update(tinyxml2::XMLElement* element)
+{
+    if (!element)
+    {
+        XmlDiagnostics::report(XmlErrorCode::NullElement, nullptr, nullptr, "Element is null");
+        return false;
+    }
+    if (!m_layout)
+    {
+        // Nothing is tracked for subclasses that serialize state of their own: rewrite it all
+        element->DeleteChildren();
+        return serialize(element);
+    }
+
+    XmlDiagnosticScope scope(element);
+    if (m_allDirty)
+    {
+        m_dirty.assign(m_layout->size(), true);
+        m_allDirty = false;
+    }
+
+    // Fields that fail stay dirty
+    bool allSuccess = true;
+    for (size_t slot : m_layout->byKey())
+    {
+        if (slot >= m_dirty.size() || !m_dirty[slot])
+            continue;
+        load(slot);
+        const XmlFieldLayout::Field& field = m_layout->field(slot);
+        if (!field.ops)
         {
-            bool temp;
-            success = wrapper >> temp;
-            if (success) value = temp;
-            else onDeserializeError(key, "Element missing or invalid");
+            onSerializeError(field.key, "Unsupported value type");
+            allSuccess = false;
         }
-        else if (value.type() == typeid(double))
+        else if (m_layout->isAttribute(slot)
+            ? !field.ops->writeAttribute(element, m_layout->elementName(slot), m_values[slot])
+            : !field.ops->update(element, m_layout->elementName(slot), m_values[slot], m_layout->itemName(slot)))
         {
-            double temp;
-            success = wrapper >> temp;
-            if (success) value = temp;
-            else onDeserializeError(key, "Element missing or invalid");
+            onSerializeError(field.key, "Failed to update element");
+            allSuccess = false;
         }
-        else if (value.type() == typeid(float))
+        else
         {
-            float temp;
-            success = wrapper >> temp;
-            if (success) value = temp;
-            else onDeserializeError(key, "Element missing or invalid");
+            m_dirty[slot] = false;
         }
-        allSuccess &= success;
     }
     return allSuccess;
 }
 
+bool XMLSerializable::update()
+{
+    if (!m_boundElement)
+    {
+        XmlDiagnostics::report(XmlErrorCode::InvalidState, nullptr, nullptr, "Object is not bound to an element");
+        return false;
+    }
+    return update(m_boundElement);
+}
+
+void XMLSerializable::bind(tinyxml2::XMLElement* element) { m_boundElement = element; }
+tinyxml2::XMLElement* XMLSerializable::boundElement() const { return m_boundElement; }
+
+bool XMLSerializable::isDirty() const
+{
+    if (m_allDirty)
+        return m_layout && !m_layout->empty();
+    return std::find(m_dirty.begin(), m_dirty.end(), true) != m_dirty.end();
+}
+
+bool XMLSerializable::isDirty(const std::string& key) const
+{
+    size_t slot = m_layout ? m_layout->find(key) : XmlFieldLayout::npos;
+    if (slot == XmlFieldLayout::npos)
+        return false;
+    return m_allDirty || (slot < m_dirty.size() && m_dirty[slot]);
+}
+
+void XMLSerializable::markDirty(const std::string& key)
+{
+    size_t slot = m_layout ? m_layout->find(key) : XmlFieldLayout::npos;
+    if (slot != XmlFieldLayout::npos)
+        touch(slot);
+}
+
+void XMLSerializable::markClean()
+{
+    m_allDirty = false;
+    m_dirty.clear();
+}
+
+const std::shared_ptr<const XmlFieldLayout>& XMLSerializable::layout() const
+{
+    return m_layout;
+}
+
+XmlFieldLayout& XMLSerializable::mutableLayout()
+{
+    if (!m_ownsLayout || m_layout.use_count() > 1)
+    {
+        auto layout = m_layout ? std::make_shared<XmlFieldLayout>(*m_layout) : std::make_shared<XmlFieldLayout>();
+        m_layout = layout;
+        m_ownsLayout = true;
+        return *layout;
+    }
+    // Created by this instance as a non-const object and not shared
+    return const_cast<XmlFieldLayout&>(*m_layout);
+}
+
+size_t XMLSerializable::checkedSlot(const std::string& key) const
+{
+    size_t slot = m_layout ? m_layout->find(key) : XmlFieldLayout::npos;
+    if (slot == XmlFieldLayout::npos)
+        throw std::out_of_range("XMLSerializable: no data for key '" + key + "'");
+    return slot;
+}
+
+void XMLSerializable::reportTypeMismatch(size_t slot) const
+{
+    XmlDiagnostics::report(XmlErrorCode::TypeMismatch, nullptr, m_layout->field(slot).key.c_str(),
+        "Stored value has another type");
+}
+
 XmlElementWrapper& operator<<(XmlElementWrapper& wrapper, const XMLSerializable& serializable)
 {
     serializable.serialize(wrapper.getElement());
@@ -0,0 +1,230 @@
+#include "XmlAsyncWriter.h"
+#include "XmlDiagnostics.h"
+#include "XMLSerializable.h"
+#include "XmlStreamWriter.h"
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <random>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    bool fail(const std::string& filename, const std::string& temporary, const char* message)
+    {
+        std::error_code ignored;
+        std::filesystem::remove(temporary, ignored);
+        XmlDiagnostics::report(XmlErrorCode::IoFailed, nullptr, filename.c_str(), message);
+        return false;
+    }
+
+    // Formats object into a buffer reused by the calling thread
+    bool format(const char* rootName, const XMLSerializable& object, bool compact, std::string& output)
+    {
+        thread_local XmlStreamWriter prettyWriter(false);
+        thread_local XmlStreamWriter compactWriter(true);
+        XmlStreamWriter& writer = compact ? compactWriter : prettyWriter;
+        writer.clearBuffer();
+        bool success = writer.write(rootName, object);
+        output.assign(writer.buffer(), writer.size());
+        return success;
+    }
+
+    std::future<bool> futureCallback(XmlAsyncWriter::Callback& callback)
+    {
+        auto promise = std::make_shared<std::promise<bool>>();
+        std::future<bool> future = promise->get_future();
+        callback = [promise](bool success) { promise->set_value(success); };
+        return future;
+    }
+}
+
+bool xmlWriteFileAtomic(const std::string& filename, const char* data, size_t size)
+{
+    // A unique name in the target's directory, so the rename stays on one file system
+    std::string temporary = filename + ".tmp" + std::to_string(std::random_device()());
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(temporary.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return fail(filename, temporary, "Failed to create temporary file");
+    bool written = true;
+    while (written && size > 0)
+    {
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+        DWORD count = 0;
+        written = WriteFile(file, data, chunk, &count, nullptr) != 0;
+        data += count;
+        size -= count;
+    }
+    written = written && FlushFileBuffers(file) != 0;
+    CloseHandle(file);
+    if (!written)
+        return fail(filename, temporary, "Failed to write temporary file");
+    if (!MoveFileExA(temporary.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+        return fail(filename, temporary, "Failed to replace file");
+#else
+    int file = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (file < 0)
+        return fail(filename, temporary, "Failed to create temporary file");
+    bool written = true;
+    while (written && size > 0)
+    {
+        ssize_t count = ::write(file, data, size);
+        if (count < 0 && errno == EINTR)
+            continue;
+        written = count > 0;
+        if (written)
+        {
+            data += count;
+            size -= static_cast<size_t>(count);
+        }
+    }
+    written = written && ::fsync(file) == 0;
+    written = ::close(file) == 0 && written;
+    if (!written)
+        return fail(filename, temporary, "Failed to write temporary file");
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0)
+        return fail(filename, temporary, "Failed to replace file");
+
+    // The rename itself is durable once the directory entry is flushed
+    std::string directory = std::filesystem::path(filename).parent_path().string();
+    int handle = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_CLOEXEC);
+    if (handle >= 0)
+    {
+        ::fsync(handle);
+        ::close(handle);
+    }
+#endif
+    return true;
+}
+
+XmlAsyncWriter::XmlAsyncWriter(XmlDiagnosticSink* sink) : m_sink(sink), m_pending(0), m_stop(false)
+{
+    m_thread = std::thread(&XmlAsyncWriter::work, this);
+}
+
+XmlAsyncWriter::~XmlAsyncWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+std::future<bool> XmlAsyncWriter::save(const std::string& filename, const char* rootName, const XMLSerializable& object, bool compact)
+{
+    Callback callback;
+    std::future<bool> future = futureCallback(callback);
+    save(filename, rootName, object, std::move(callback), compact);
+    return future;
+}
+
+void XmlAsyncWriter::save(const std::string& filename, const char* rootName, const XMLSerializable& object, Callback callback, bool compact)
+{
+    // A failed serialization is never written, so it neither replaces the file nor a waiting save
+    std::string content;
+    if (!format(rootName, object, compact, content))
+    {
+        if (callback)
+            callback(false);
+        return;
+    }
+    enqueue(filename, std::move(content), std::move(callback));
+}
+
+std::future<bool> XmlAsyncWriter::save(const std::string& filename, std::string content)
+{
+    Callback callback;
+    std::future<bool> future = futureCallback(callback);
+    enqueue(filename, std::move(content), std::move(callback));
+    return future;
+}
+
+void XmlAsyncWriter::save(const std::string& filename, std::string content, Callback callback)
+{
+    enqueue(filename, std::move(content), std::move(callback));
+}
+
+void XmlAsyncWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_pending == 0; });
+}
+
+size_t XmlAsyncWriter::pending() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending;
+}
+
+XmlAsyncWriter& XmlAsyncWriter::shared()
+{
+    static XmlAsyncWriter writer;
+    return writer;
+}
+
+void XmlAsyncWriter::enqueue(const std::string& filename, std::string content, Callback callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto inserted = m_jobs.try_emplace(filename);
+        Job& job = inserted.first->second;
+        if (inserted.second)
+        {
+            m_order.push_back(filename);
+            ++m_pending;
+        }
+        // A waiting save of the same file is superseded; its old content is never written
+        job.content = std::move(content);
+        if (callback)
+            job.callbacks.push_back(std::move(callback));
+    }
+    m_wake.notify_one();
+}
+
+void XmlAsyncWriter::work()
+{
+    std::unique_ptr<XmlScopedSink> sink;
+    if (m_sink)
+        sink = std::make_unique<XmlScopedSink>(*m_sink);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        m_wake.wait(lock, [this] { return m_stop || !m_order.empty(); });
+        if (m_order.empty())
+            return;
+
+        // Taken out of the map, so saves arriving during the write queue another one
+        std::string filename = std::move(m_order.front());
+        m_order.pop_front();
+        auto found = m_jobs.find(filename);
+        Job job = std::move(found->second);
+        m_jobs.erase(found);
+        lock.unlock();
+
+        bool success = xmlWriteFileAtomic(filename, job.content.data(), job.content.size());
+        for (Callback& callback : job.callbacks)
+            callback(success);
+
+        lock.lock();
+        if (--m_pending == 0)
+            m_idle.notify_all();
+    }
+}
@@ -0,0 +1,30 @@
+#include "XmlBatch.h"
+#include <cstdio>
+
+bool xmlReadFile(const std::string& filename, std::string& content)
+{
+    content.clear();
+    FILE* file = std::fopen(filename.c_str(), "rb");
+    if (!file)
+    {
+        XmlDiagnostics::report(XmlErrorCode::IoFailed, nullptr, filename.c_str(), "Failed to open file");
+        return false;
+    }
+
+    long size = -1;
+    if (std::fseek(file, 0, SEEK_END) == 0)
+        size = std::ftell(file);
+    bool success = size >= 0 && std::fseek(file, 0, SEEK_SET) == 0;
+    if (success)
+    {
+        content.resize(static_cast<size_t>(size));
+        success = std::fread(&content[0], 1, content.size(), file) == content.size();
+    }
+    std::fclose(file);
+    if (!success)
+    {
+        content.clear();
+        XmlDiagnostics::report(XmlErrorCode::IoFailed, nullptr, filename.c_str(), "Failed to read file");
+    }
+    return success;
+}
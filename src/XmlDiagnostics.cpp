@@ -0,0 +1,98 @@
+#include "XmlDiagnostics.h"
+#include <atomic>
+#include <iostream>
+
+namespace
+{
+    XmlConsoleSink consoleSink;
+    std::atomic<bool> diagnosticsEnabled(true);
+    thread_local XmlDiagnosticSink* threadSink = nullptr;
+    thread_local const tinyxml2::XMLNode* currentElement = nullptr;
+}
+
+const char* toString(XmlErrorCode code)
+{
+    switch (code)
+    {
+    case XmlErrorCode::NullElement: return "NullElement";
+    case XmlErrorCode::ElementNotFound: return "ElementNotFound";
+    case XmlErrorCode::MissingText: return "MissingText";
+    case XmlErrorCode::ConversionFailed: return "ConversionFailed";
+    case XmlErrorCode::FormatFailed: return "FormatFailed";
+    case XmlErrorCode::DeserializeFailed: return "DeserializeFailed";
+    case XmlErrorCode::SerializeFailed: return "SerializeFailed";
+    case XmlErrorCode::ParseFailed: return "ParseFailed";
+    case XmlErrorCode::IoFailed: return "IoFailed";
+    case XmlErrorCode::InvalidState: return "InvalidState";
+    case XmlErrorCode::TypeMismatch: return "TypeMismatch";
+    }
+    return "Unknown";
+}
+
+void XmlConsoleSink::report(const XmlDiagnostic& diagnostic)
+{
+    std::cerr << "Error [" << toString(diagnostic.code) << "]";
+    if (!diagnostic.path.empty() || !diagnostic.key.empty())
+    {
+        std::cerr << " '" << diagnostic.path;
+        if (!diagnostic.path.empty() && !diagnostic.key.empty())
+            std::cerr << '/';
+        std::cerr << diagnostic.key << "'";
+    }
+    std::cerr << ": " << diagnostic.message << '\n';
+}
+
+void XmlCollectingSink::report(const XmlDiagnostic& diagnostic) { m_diagnostics.push_back(diagnostic); }
+const std::vector<XmlDiagnostic>& XmlCollectingSink::diagnostics() const { return m_diagnostics; }
+bool XmlCollectingSink::empty() const { return m_diagnostics.empty(); }
+void XmlCollectingSink::clear() { m_diagnostics.clear(); }
+
+void XmlDiagnostics::setSink(XmlDiagnosticSink* sink) { threadSink = sink; }
+XmlDiagnosticSink& XmlDiagnostics::sink() { return threadSink ? *threadSink : consoleSink; }
+void XmlDiagnostics::setEnabled(bool enabled) { diagnosticsEnabled.store(enabled, std::memory_order_relaxed); }
+
+#ifndef TINYXMLHELPER_DISABLE_DIAGNOSTICS
+bool XmlDiagnostics::enabled() { return diagnosticsEnabled.load(std::memory_order_relaxed); }
+#endif
+
+std::string XmlDiagnostics::path(const tinyxml2::XMLNode* node)
+{
+    std::vector<const char*> names;
+    for (; node; node = node->Parent())
+    {
+        const tinyxml2::XMLElement* element = node->ToElement();
+        if (element)
+            names.push_back(element->Name());
+    }
+
+    std::string result;
+    for (auto name = names.rbegin(); name != names.rend(); ++name)
+    {
+        if (!result.empty())
+            result += '/';
+        result += *name;
+    }
+    return result;
+}
+
+void XmlDiagnostics::dispatch(XmlErrorCode code, const tinyxml2::XMLNode* element, const char* key, const char* message)
+{
+    XmlDiagnostic diagnostic;
+    diagnostic.code = code;
+    diagnostic.path = path(element ? element : currentElement);
+    diagnostic.key = key ? key : "";
+    diagnostic.message = message ? message : "";
+    sink().report(diagnostic);
+}
+
+XmlScopedSink::XmlScopedSink(XmlDiagnosticSink& sink) : m_previous(threadSink) { threadSink = &sink; }
+XmlScopedSink::~XmlScopedSink() { threadSink = m_previous; }
+
+XmlDiagnosticScope::XmlDiagnosticScope(const tinyxml2::XMLNode* element) : m_previous(currentElement)
+{
+    currentElement = element;
+}
+
+XmlDiagnosticScope::~XmlDiagnosticScope() { currentElement = m_previous; }
+
+const tinyxml2::XMLNode* XmlDiagnosticScope::current() { return currentElement; }
@@ -0,0 +1,145 @@
+#include "XmlDocumentPool.h"
+#include "XmlDiagnostics.h"
+#include "XMLSerializable.h"
+#include <cstring>
+
+XmlPooledDocument::XmlPooledDocument(XmlDocumentPool* pool, std::unique_ptr<tinyxml2::XMLDocument> document)
+    : m_pool(pool), m_document(std::move(document))
+{
+}
+
+XmlPooledDocument::XmlPooledDocument(XmlPooledDocument&& other) noexcept
+    : m_pool(other.m_pool), m_document(std::move(other.m_document))
+{
+}
+
+XmlPooledDocument& XmlPooledDocument::operator=(XmlPooledDocument&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        m_pool = other.m_pool;
+        m_document = std::move(other.m_document);
+    }
+    return *this;
+}
+
+XmlPooledDocument::~XmlPooledDocument()
+{
+    release();
+}
+
+tinyxml2::XMLDocument& XmlPooledDocument::document() { return *m_document; }
+tinyxml2::XMLDocument* XmlPooledDocument::operator->() { return m_document.get(); }
+
+void XmlPooledDocument::release()
+{
+    if (m_document)
+        m_pool->release(std::move(m_document));
+}
+
+XmlDocumentPool::XmlDocumentPool(size_t maxDocuments)
+    : m_maxDocuments(maxDocuments), m_printer(nullptr, false), m_compactPrinter(nullptr, true)
+{
+    m_documents.reserve(maxDocuments);
+}
+
+XmlPooledDocument XmlDocumentPool::acquire()
+{
+    if (m_documents.empty())
+        return XmlPooledDocument(this, std::make_unique<tinyxml2::XMLDocument>());
+
+    std::unique_ptr<tinyxml2::XMLDocument> document = std::move(m_documents.back());
+    m_documents.pop_back();
+    return XmlPooledDocument(this, std::move(document));
+}
+
+void XmlDocumentPool::reserve(size_t count)
+{
+    while (m_documents.size() < count && m_documents.size() < m_maxDocuments)
+        m_documents.push_back(std::make_unique<tinyxml2::XMLDocument>());
+}
+
+size_t XmlDocumentPool::available() const
+{
+    return m_documents.size();
+}
+
+bool XmlDocumentPool::deserialize(const char* text, size_t size, const char* rootName, XMLSerializable& object)
+{
+    XmlPooledDocument document = acquire();
+    if (document->Parse(text, size) != tinyxml2::XML_SUCCESS)
+    {
+        XmlDiagnostics::report(XmlErrorCode::ParseFailed, nullptr, rootName, document->ErrorStr());
+        return false;
+    }
+    return deserializeRoot(document.document(), rootName, object);
+}
+
+bool XmlDocumentPool::deserializeFile(const std::string& filename, const char* rootName, XMLSerializable& object)
+{
+    XmlPooledDocument document = acquire();
+    tinyxml2::XMLError error = document->LoadFile(filename.c_str());
+    if (error != tinyxml2::XML_SUCCESS)
+    {
+        bool io = error == tinyxml2::XML_ERROR_FILE_NOT_FOUND || error == tinyxml2::XML_ERROR_FILE_COULD_NOT_BE_OPENED
+            || error == tinyxml2::XML_ERROR_FILE_READ_ERROR;
+        XmlDiagnostics::report(io ? XmlErrorCode::IoFailed : XmlErrorCode::ParseFailed, nullptr, filename.c_str(), document->ErrorStr());
+        return false;
+    }
+    return deserializeRoot(document.document(), rootName, object);
+}
+
+bool XmlDocumentPool::serialize(const char* rootName, const XMLSerializable& object, std::string& output, bool compact)
+{
+    XmlPooledDocument document = acquire();
+    tinyxml2::XMLElement* root = document->NewElement(rootName);
+    document->InsertEndChild(root);
+    bool success = object.serialize(root);
+
+    tinyxml2::XMLPrinter& printer = compact ? m_compactPrinter : m_printer;
+    printer.ClearBuffer();
+    document->Print(&printer);
+    output.assign(printer.CStr(), printer.CStrSize() > 0 ? printer.CStrSize() - 1 : 0);
+    return success;
+}
+
+bool XmlDocumentPool::serializeFile(const std::string& filename, const char* rootName, const XMLSerializable& object, bool compact)
+{
+    XmlPooledDocument document = acquire();
+    tinyxml2::XMLElement* root = document->NewElement(rootName);
+    document->InsertEndChild(root);
+    bool success = object.serialize(root);
+
+    if (document->SaveFile(filename.c_str(), compact) != tinyxml2::XML_SUCCESS)
+    {
+        XmlDiagnostics::report(XmlErrorCode::IoFailed, nullptr, filename.c_str(), "Failed to save file");
+        return false;
+    }
+    return success;
+}
+
+XmlDocumentPool& XmlDocumentPool::local()
+{
+    thread_local XmlDocumentPool pool;
+    return pool;
+}
+
+void XmlDocumentPool::release(std::unique_ptr<tinyxml2::XMLDocument> document)
+{
+    // Clear keeps the document's node memory pools for the next use
+    document->Clear();
+    if (m_documents.size() < m_maxDocuments)
+        m_documents.push_back(std::move(document));
+}
+
+bool XmlDocumentPool::deserializeRoot(tinyxml2::XMLDocument& document, const char* rootName, XMLSerializable& object)
+{
+    tinyxml2::XMLElement* root = document.RootElement();
+    if (!root || std::strcmp(root->Name(), rootName) != 0)
+    {
+        XmlDiagnostics::report(XmlErrorCode::ElementNotFound, nullptr, rootName, "Root element not found");
+        return false;
+    }
+    return object.deserialize(root);
+}
@@ -1,14 +1,16 @@
 #include "XmlElementWrapper.h"
+#include "XmlMetrics.h"
 
 XmlElementWrapper::XmlElementWrapper(tinyxml2::XMLElement* element, const char* name, bool createIfNotFound)
 {
     if (!element)
     {
-        std::cerr << "Error: Parent element is null for '" << name << "'" << std::endl;
+        XmlDiagnostics::report(XmlErrorCode::NullElement, nullptr, name, "Parent element is null");
         this->element = nullptr;
         return;
     }
 
+    XmlMetrics::record(XmlMetricEvent::Lookup, name);
     this->element = element->FirstChildElement(name);
     if (!this->element && createIfNotFound)
     {
@@ -17,22 +19,24 @@ XmlElementWrapper::XmlElementWrapper(tinyxml2::XMLElement* element, const char*
     }
     else if (!this->element)
     {
-        std::cerr << "Error: Element with name '" << name << "' not found under '"
-            << element->Name() << "'" << std::endl;
+        XmlMetrics::record(XmlMetricEvent::Miss, name);
+        XmlDiagnostics::report(XmlErrorCode::ElementNotFound, element, name, "Element not found");
     }
 }
 
+XmlElementWrapper::XmlElementWrapper(tinyxml2::XMLElement* element) : element(element) {}
+
 tinyxml2::XMLElement* XmlElementWrapper::getElement() const { return element; }
 
 // Overloaded operator>> for deserializing
 bool XmlElementWrapper::operator>>(std::string& value) { return getText(value); }
-bool XmlElementWrapper::operator>>(int& value) { return queryText(&tinyxml2::XMLElement::QueryIntText, value); }
-bool XmlElementWrapper::operator>>(unsigned int& value) { return queryText(&tinyxml2::XMLElement::QueryUnsignedText, value); }
-bool XmlElementWrapper::operator>>(int64_t& value) { return queryText(&tinyxml2::XMLElement::QueryInt64Text, value); }
-bool XmlElementWrapper::operator>>(uint64_t& value) { return queryText(&tinyxml2::XMLElement::QueryUnsigned64Text, value); }
-bool XmlElementWrapper::operator>>(bool& value) { return queryText(&tinyxml2::XMLElement::QueryBoolText, value); }
-bool XmlElementWrapper::operator>>(double& value) { return queryText(&tinyxml2::XMLElement::QueryDoubleText, value); }
-bool XmlElementWrapper::operator>>(float& value) { return queryText(&tinyxml2::XMLElement::QueryFloatText, value); }
+bool XmlElementWrapper::operator>>(int& value) { return parseText(value); }
+bool XmlElementWrapper::operator>>(unsigned int& value) { return parseText(value); }
+bool XmlElementWrapper::operator>>(int64_t& value) { return parseText(value); }
+bool XmlElementWrapper::operator>>(uint64_t& value) { return parseText(value); }
+bool XmlElementWrapper::operator>>(bool& value) { return parseText(value); }
+bool XmlElementWrapper::operator>>(double& value) { return parseText(value); }
+bool XmlElementWrapper::operator>>(float& value) { return parseText(value); }
 
 // Overloaded operator<< for serializing
 bool XmlElementWrapper::operator<<(const std::string& value) { return setText(value); }
@@ -40,27 +44,29 @@ bool XmlElementWrapper::operator<<(int value) { return setText(value); }
 bool XmlElementWrapper::operator<<(unsigned int value) { return setText(value); }
 bool XmlElementWrapper::operator<<(int64_t value) { return setText(value); }
 bool XmlElementWrapper::operator<<(uint64_t value) { return setText(value); }
-bool XmlElementWrapper::operator<<(bool value) { return setText(value ? "true" : "false"); }
+bool XmlElementWrapper::operator<<(bool value) { return setText(value); }
 bool XmlElementWrapper::operator<<(double value) { return setText(value); }
 bool XmlElementWrapper::operator<<(float value) { return setText(value); }
 
-void XmlElementWrapper::reportError(const char* value)
+void XmlElementWrapper::report(XmlErrorCode code, const char* message) const
 {
-    std::cerr << "Error: Element with name '" << value << "' not found." << std::endl;
-    std::exit(EXIT_FAILURE);
+    if (element)
+        XmlDiagnostics::report(code, element->Parent(), element->Name(), message);
+    else
+        XmlDiagnostics::report(code, nullptr, nullptr, message);
 }
 
 bool XmlElementWrapper::getText(std::string& value)
 {
     if (!element)
     {
-        std::cerr << "Error: Element is null." << std::endl;
+        report(XmlErrorCode::NullElement, "Element is null");
         return false;
     }
     const char* text = element->GetText();
     if (!text)
     {
-        std::cerr << "Error: Element text is null." << std::endl;
+        report(XmlErrorCode::MissingText, "Element text is null");
         return false;
     }
     value = text;
@@ -72,7 +78,7 @@ bool XmlElementWrapper::setText(const std::string& value)
 {
     if (!element)
     {
-        std::cerr << "Error: Element is null." << std::endl;
+        report(XmlErrorCode::NullElement, "Element is null");
         return false;
     }
     element->SetText(value.c_str());
@@ -84,13 +90,109 @@ bool XmlElementWrapper::setText(const char* value)
 {
     if (!element)
     {
-        std::cerr << "Error: Element is null." << std::endl;
+        report(XmlErrorCode::NullElement, "Element is null");
         return false;
     }
     element->SetText(value);
     return true;
 }
 
+template<typename T>
+bool XmlElementWrapper::setArray(const std::vector<T>& value)
+{
+    if (!element)
+    {
+        report(XmlErrorCode::NullElement, "Element is null");
+        return false;
+    }
+    if (value.empty())
+    {
+        element->DeleteChildren();
+        return true;
+    }
+    // Formatting buffer kept per thread, so its capacity is reused across arrays
+    thread_local std::string buffer;
+    buffer.clear();
+    if (!XmlNumericCodec::formatArray(buffer, value.data(), value.size()))
+    {
+        report(XmlErrorCode::FormatFailed, "Failed to format array for element");
+        return false;
+    }
+    element->SetText(buffer.c_str());
+    return true;
+}
+
+bool XmlElementWrapper::operator>>(XmlPackedArray<int>& value) { return parseArray(value); }
+bool XmlElementWrapper::operator>>(XmlPackedArray<int64_t>& value) { return parseArray(value); }
+bool XmlElementWrapper::operator>>(XmlPackedArray<float>& value) { return parseArray(value); }
+bool XmlElementWrapper::operator>>(XmlPackedArray<double>& value) { return parseArray(value); }
+
+bool XmlElementWrapper::operator<<(const XmlPackedArray<int>& value) { return setArray(value); }
+bool XmlElementWrapper::operator<<(const XmlPackedArray<int64_t>& value) { return setArray(value); }
+bool XmlElementWrapper::operator<<(const XmlPackedArray<float>& value) { return setArray(value); }
+bool XmlElementWrapper::operator<<(const XmlPackedArray<double>& value) { return setArray(value); }
+
+XmlAttributeWrapper::XmlAttributeWrapper(tinyxml2::XMLElement* element, const char* name)
+    : m_element(element), m_name(name)
+{
+    if (!element)
+        XmlDiagnostics::report(XmlErrorCode::NullElement, nullptr, name, "Parent element is null");
+}
+
+tinyxml2::XMLElement* XmlAttributeWrapper::getElement() const { return m_element; }
+const char* XmlAttributeWrapper::getName() const { return m_name; }
+bool XmlAttributeWrapper::exists() const { return m_element && m_element->FindAttribute(m_name); }
+
+bool XmlAttributeWrapper::operator>>(std::string& value)
+{
+    const char* text = getText();
+    if (!text)
+        return false;
+    value = text;
+    return true;
+}
+
+bool XmlAttributeWrapper::operator>>(int& value) { return parseNumber(value); }
+bool XmlAttributeWrapper::operator>>(unsigned int& value) { return parseNumber(value); }
+bool XmlAttributeWrapper::operator>>(int64_t& value) { return parseNumber(value); }
+bool XmlAttributeWrapper::operator>>(uint64_t& value) { return parseNumber(value); }
+bool XmlAttributeWrapper::operator>>(bool& value) { return parseNumber(value); }
+bool XmlAttributeWrapper::operator>>(double& value) { return parseNumber(value); }
+bool XmlAttributeWrapper::operator>>(float& value) { return parseNumber(value); }
+
+bool XmlAttributeWrapper::operator<<(const std::string& value) { return setText(value.c_str()); }
+bool XmlAttributeWrapper::operator<<(int value) { return setNumber(value); }
+bool XmlAttributeWrapper::operator<<(unsigned int value) { return setNumber(value); }
+bool XmlAttributeWrapper::operator<<(int64_t value) { return setNumber(value); }
+bool XmlAttributeWrapper::operator<<(uint64_t value) { return setNumber(value); }
+bool XmlAttributeWrapper::operator<<(bool value) { return setNumber(value); }
+bool XmlAttributeWrapper::operator<<(double value) { return setNumber(value); }
+bool XmlAttributeWrapper::operator<<(float value) { return setNumber(value); }
+
+void XmlAttributeWrapper::report(XmlErrorCode code, const char* message) const
+{
+    XmlDiagnostics::report(code, m_element, m_name, message);
+}
+
+const char* XmlAttributeWrapper::getText()
+{
+    if (!m_element)
+        return nullptr;
+    const char* text = m_element->Attribute(m_name);
+    if (!text)
+        report(XmlErrorCode::ElementNotFound, "Attribute not found");
+    return text;
+}
+
+bool XmlAttributeWrapper::setText(const char* value)
+{
+    if (!m_element)
+        return false;
+    // Replaces the value of an existing attribute in place
+    m_element->SetAttribute(m_name, value);
+    return true;
+}
+
 // External helper functions for deserialization
 bool deserialize(tinyxml2::XMLElement* element, const char* name, std::string& value)
 {
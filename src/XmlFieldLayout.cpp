@@ -0,0 +1,75 @@
+#include "XmlFieldLayout.h"
+#include <algorithm>
+#include <cstring>
+
+size_t XmlFieldLayout::find(std::string_view key) const
+{
+    auto slot = std::lower_bound(m_byKey.begin(), m_byKey.end(), key,
+        [this](size_t entry, std::string_view target) { return m_fields[entry].key < target; });
+    return slot != m_byKey.end() && m_fields[*slot].key == key ? *slot : npos;
+}
+
+size_t XmlFieldLayout::size() const { return m_fields.size(); }
+bool XmlFieldLayout::empty() const { return m_fields.empty(); }
+const XmlFieldLayout::Field& XmlFieldLayout::field(size_t slot) const { return m_fields[slot]; }
+
+const char* XmlFieldLayout::elementName(size_t slot) const
+{
+    const Field& field = m_fields[slot];
+    return field.element.empty() ? field.key.c_str() : field.element.c_str();
+}
+
+const char* XmlFieldLayout::itemName(size_t slot) const
+{
+    const Field& field = m_fields[slot];
+    return field.item.empty() ? XmlDefaultItemName : field.item.c_str();
+}
+
+bool XmlFieldLayout::isAttribute(size_t slot) const
+{
+    const Field& field = m_fields[slot];
+    return field.ops && field.ops->attribute && (field.attribute || m_scalarsAsAttributes);
+}
+
+void XmlFieldLayout::setScalarsAsAttributes(bool enabled) { m_scalarsAsAttributes = enabled; }
+bool XmlFieldLayout::scalarsAsAttributes() const { return m_scalarsAsAttributes; }
+
+const std::vector<size_t>& XmlFieldLayout::byKey() const { return m_byKey; }
+const std::vector<size_t>& XmlFieldLayout::byElement() const { return m_byElement; }
+uint64_t XmlFieldLayout::signature() const { return m_signature; }
+
+size_t XmlFieldLayout::insert(Field field)
+{
+    // Replacing keeps the slot, so handles and instance values stay valid
+    size_t slot = find(field.key);
+    if (slot != npos)
+    {
+        m_fields[slot] = std::move(field);
+        m_byElement.erase(std::find(m_byElement.begin(), m_byElement.end(), slot));
+    }
+    else
+    {
+        slot = m_fields.size();
+        m_fields.push_back(std::move(field));
+        auto position = std::lower_bound(m_byKey.begin(), m_byKey.end(), m_fields[slot].key,
+            [this](size_t entry, const std::string& target) { return m_fields[entry].key < target; });
+        m_byKey.insert(position, slot);
+    }
+
+    const char* name = elementName(slot);
+    auto position = std::lower_bound(m_byElement.begin(), m_byElement.end(), name,
+        [this](size_t entry, const char* target) { return std::strcmp(elementName(entry), target) < 0; });
+    m_byElement.insert(position, slot);
+
+    m_signature = xmlSnapshotHash(nullptr, 0);
+    for (size_t entry : m_byKey)
+    {
+        const Field& current = m_fields[entry];
+        const char* type = current.defaultValue.type().name();
+        m_signature = xmlSnapshotHash(current.key.data(), current.key.size() + 1, m_signature);
+        m_signature = xmlSnapshotHash(elementName(entry), std::strlen(elementName(entry)) + 1, m_signature);
+        m_signature = xmlSnapshotHash(itemName(entry), std::strlen(itemName(entry)) + 1, m_signature);
+        m_signature = xmlSnapshotHash(type, std::strlen(type), m_signature);
+    }
+    return slot;
+}
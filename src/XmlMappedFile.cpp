@@ -0,0 +1,131 @@
+#include "XmlMappedFile.h"
+#include "XmlDiagnostics.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+XmlMappedFile::XmlMappedFile() : m_data(nullptr), m_size(0), m_open(false) {}
+
+XmlMappedFile::XmlMappedFile(const std::string& filename) : XmlMappedFile()
+{
+    open(filename);
+}
+
+XmlMappedFile::~XmlMappedFile()
+{
+    close();
+}
+
+XmlMappedFile::XmlMappedFile(XmlMappedFile&& other) noexcept
+    : m_data(other.m_data), m_size(other.m_size), m_open(other.m_open)
+{
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_open = false;
+}
+
+XmlMappedFile& XmlMappedFile::operator=(XmlMappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        m_data = other.m_data;
+        m_size = other.m_size;
+        m_open = other.m_open;
+        other.m_data = nullptr;
+        other.m_size = 0;
+        other.m_open = false;
+    }
+    return *this;
+}
+
+bool XmlMappedFile::open(const std::string& filename)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        XmlDiagnostics::report(XmlErrorCode::IoFailed, nullptr, filename.c_str(), "Failed to open file");
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    bool success = GetFileSizeEx(file, &size) != 0;
+    if (success && size.QuadPart > 0)
+    {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (mapping)
+            CloseHandle(mapping);
+        success = view != nullptr;
+        m_data = static_cast<const char*>(view);
+        m_size = success ? static_cast<size_t>(size.QuadPart) : 0;
+    }
+    CloseHandle(file);
+#else
+    int file = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0)
+    {
+        XmlDiagnostics::report(XmlErrorCode::IoFailed, nullptr, filename.c_str(), "Failed to open file");
+        return false;
+    }
+
+    struct stat status;
+    bool success = ::fstat(file, &status) == 0;
+    if (success && status.st_size > 0)
+    {
+        void* view = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        success = view != MAP_FAILED;
+        if (success)
+        {
+            // Parsers read front to back: read ahead aggressively and drop pages behind the reader
+            ::madvise(view, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+            m_data = static_cast<const char*>(view);
+            m_size = static_cast<size_t>(status.st_size);
+        }
+    }
+    ::close(file);  // The mapping keeps the file contents available
+#endif
+
+    if (!success)
+    {
+        XmlDiagnostics::report(XmlErrorCode::IoFailed, nullptr, filename.c_str(), "Failed to map file");
+        return false;
+    }
+    m_open = true;
+    return true;
+}
+
+void XmlMappedFile::close()
+{
+    if (m_data)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+#else
+        ::munmap(const_cast<char*>(m_data), m_size);
+#endif
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+bool XmlMappedFile::isOpen() const { return m_open; }
+const char* XmlMappedFile::data() const { return m_data; }
+size_t XmlMappedFile::size() const { return m_size; }
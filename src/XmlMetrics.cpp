@@ -0,0 +1,344 @@
+#include "XmlMetrics.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+namespace
+{
+    std::string escapeJson(const std::string& text)
+    {
+        std::string result;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                result += '\\';
+            result += c;
+        }
+        return result;
+    }
+
+#ifdef TINYXMLHELPER_ENABLE_METRICS
+    std::string className(const std::type_info* type)
+    {
+        if (!type)
+            return std::string();
+#if defined(__GNUG__)
+        int status = 0;
+        std::unique_ptr<char, void (*)(void*)> demangled(abi::__cxa_demangle(type->name(), nullptr, nullptr, &status), std::free);
+        if (status == 0 && demangled)
+            return demangled.get();
+        return type->name();
+#else
+        // MSVC names carry a "class " or "struct " prefix
+        std::string name = type->name();
+        for (const char* prefix : { "class ", "struct " })
+        {
+            if (name.compare(0, std::strlen(prefix), prefix) == 0)
+                return name.substr(std::strlen(prefix));
+        }
+        return name;
+#endif
+    }
+
+    struct ClassAccumulator
+    {
+        XmlTimingHistogram serialize;
+        XmlTimingHistogram deserialize;
+        // Transparent comparator: keys are found without building a std::string
+        std::map<std::string, XmlKeyCounters, std::less<>> keys;
+    };
+
+    using Accumulator = std::unordered_map<const std::type_info*, ClassAccumulator>;
+
+    void mergeInto(XmlMetricsSnapshot& snapshot, const Accumulator& accumulator)
+    {
+        for (const auto& entry : accumulator)
+        {
+            XmlClassMetrics& metrics = snapshot.classes[className(entry.first)];
+            metrics.serialize.merge(entry.second.serialize);
+            metrics.deserialize.merge(entry.second.deserialize);
+            for (const auto& key : entry.second.keys)
+                metrics.keys[key.first].merge(key.second);
+        }
+    }
+
+    struct ThreadMetrics;
+
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<ThreadMetrics*> threads;
+        XmlMetricsSnapshot retired;     // Counters of threads that have exited
+    };
+
+    // Never destroyed, so threads exiting during static destruction can still retire their counters
+    Registry& registry()
+    {
+        static Registry* instance = new Registry;
+        return *instance;
+    }
+
+    // Counters of one thread. The owning thread locks its own mutex, which is uncontended except
+    // while a snapshot or reset reads it.
+    struct ThreadMetrics
+    {
+        std::mutex mutex;
+        Accumulator classes;
+
+        ThreadMetrics()
+        {
+            Registry& shared = registry();
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            shared.threads.push_back(this);
+        }
+
+        ~ThreadMetrics()
+        {
+            Registry& shared = registry();
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            shared.threads.erase(std::remove(shared.threads.begin(), shared.threads.end(), this), shared.threads.end());
+            mergeInto(shared.retired, classes);
+        }
+    };
+
+    ThreadMetrics& localMetrics()
+    {
+        thread_local ThreadMetrics metrics;
+        return metrics;
+    }
+
+    std::atomic<bool> metricsEnabled(true);
+    thread_local const std::type_info* currentType = nullptr;
+#endif
+}
+
+void XmlKeyCounters::merge(const XmlKeyCounters& other)
+{
+    lookups += other.lookups;
+    misses += other.misses;
+    conversions += other.conversions;
+    failures += other.failures;
+}
+
+void XmlTimingHistogram::add(uint64_t nanoseconds)
+{
+    size_t bucket = 0;
+    for (uint64_t rest = nanoseconds >> 1; rest && bucket + 1 < Buckets; rest >>= 1)
+        ++bucket;
+    ++buckets[bucket];
+    ++count;
+    totalNanoseconds += nanoseconds;
+    maxNanoseconds = std::max(maxNanoseconds, nanoseconds);
+}
+
+void XmlTimingHistogram::merge(const XmlTimingHistogram& other)
+{
+    for (size_t bucket = 0; bucket < Buckets; ++bucket)
+        buckets[bucket] += other.buckets[bucket];
+    count += other.count;
+    totalNanoseconds += other.totalNanoseconds;
+    maxNanoseconds = std::max(maxNanoseconds, other.maxNanoseconds);
+}
+
+uint64_t XmlTimingHistogram::percentile(double fraction) const
+{
+    if (count == 0)
+        return 0;
+    uint64_t target = static_cast<uint64_t>(std::max(1.0, fraction * static_cast<double>(count) + 0.5));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < Buckets; ++bucket)
+    {
+        seen += buckets[bucket];
+        if (seen >= target)
+            return std::min(maxNanoseconds, (uint64_t(2) << bucket) - 1);
+    }
+    return maxNanoseconds;
+}
+
+void XmlClassMetrics::merge(const XmlClassMetrics& other)
+{
+    serialize.merge(other.serialize);
+    deserialize.merge(other.deserialize);
+    for (const auto& key : other.keys)
+        keys[key.first].merge(key.second);
+}
+
+bool XmlMetricsSnapshot::empty() const
+{
+    return classes.empty();
+}
+
+void XmlMetricsSnapshot::merge(const XmlMetricsSnapshot& other)
+{
+    for (const auto& entry : other.classes)
+        classes[entry.first].merge(entry.second);
+}
+
+std::string XmlMetricsSnapshot::toText() const
+{
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(3);
+    for (const auto& entry : classes)
+    {
+        text << (entry.first.empty() ? "(no class)" : entry.first) << '\n';
+        const std::pair<const char*, const XmlTimingHistogram*> phases[] = {
+            { "serialize", &entry.second.serialize }, { "deserialize", &entry.second.deserialize } };
+        for (const auto& phase : phases)
+        {
+            const XmlTimingHistogram& timing = *phase.second;
+            if (timing.count == 0)
+                continue;
+            text << "  " << std::left << std::setw(12) << phase.first << std::right
+                 << " calls " << timing.count
+                 << "  total " << timing.totalNanoseconds / 1e6 << " ms"
+                 << "  mean " << timing.totalNanoseconds / 1e3 / timing.count << " us"
+                 << "  p50 <" << timing.percentile(0.5) / 1e3 << " us"
+                 << "  p99 <" << timing.percentile(0.99) / 1e3 << " us"
+                 << "  max " << timing.maxNanoseconds / 1e3 << " us\n";
+        }
+        if (!entry.second.keys.empty())
+        {
+            text << "  " << std::left << std::setw(24) << "key" << std::right << std::setw(12) << "lookups"
+                 << std::setw(12) << "misses" << std::setw(12) << "conversions" << std::setw(12) << "failures" << '\n';
+            for (const auto& key : entry.second.keys)
+            {
+                text << "  " << std::left << std::setw(24) << key.first << std::right
+                     << std::setw(12) << key.second.lookups << std::setw(12) << key.second.misses
+                     << std::setw(12) << key.second.conversions << std::setw(12) << key.second.failures << '\n';
+            }
+        }
+    }
+    return text.str();
+}
+
+std::string XmlMetricsSnapshot::toJson() const
+{
+    std::ostringstream json;
+    json << "{\"classes\": [";
+    bool firstClass = true;
+    for (const auto& entry : classes)
+    {
+        json << (firstClass ? "\n" : ",\n") << "  {\"name\": \"" << escapeJson(entry.first) << "\"";
+        firstClass = false;
+
+        const std::pair<const char*, const XmlTimingHistogram*> phases[] = {
+            { "serialize", &entry.second.serialize }, { "deserialize", &entry.second.deserialize } };
+        for (const auto& phase : phases)
+        {
+            const XmlTimingHistogram& timing = *phase.second;
+            json << ", \"" << phase.first << "\": {\"count\": " << timing.count
+                 << ", \"totalNanoseconds\": " << timing.totalNanoseconds
+                 << ", \"maxNanoseconds\": " << timing.maxNanoseconds << ", \"buckets\": [";
+            // Trailing empty buckets are left out
+            size_t used = XmlTimingHistogram::Buckets;
+            while (used > 0 && timing.buckets[used - 1] == 0)
+                --used;
+            for (size_t bucket = 0; bucket < used; ++bucket)
+                json << (bucket ? ", " : "") << timing.buckets[bucket];
+            json << "]}";
+        }
+
+        json << ", \"keys\": [";
+        bool firstKey = true;
+        for (const auto& key : entry.second.keys)
+        {
+            json << (firstKey ? "\n" : ",\n") << "    {\"key\": \"" << escapeJson(key.first) << "\""
+                 << ", \"lookups\": " << key.second.lookups << ", \"misses\": " << key.second.misses
+                 << ", \"conversions\": " << key.second.conversions << ", \"failures\": " << key.second.failures << "}";
+            firstKey = false;
+        }
+        json << (firstKey ? "]}" : "\n  ]}");
+    }
+    json << (firstClass ? "]}\n" : "\n]}\n");
+    return json.str();
+}
+
+#ifdef TINYXMLHELPER_ENABLE_METRICS
+void XmlMetrics::setEnabled(bool enabled) { metricsEnabled.store(enabled, std::memory_order_relaxed); }
+bool XmlMetrics::enabled() { return metricsEnabled.load(std::memory_order_relaxed); }
+
+void XmlMetrics::dispatch(XmlMetricEvent event, const char* key)
+{
+    ThreadMetrics& metrics = localMetrics();
+    std::lock_guard<std::mutex> lock(metrics.mutex);
+    auto& keys = metrics.classes[currentType].keys;
+    std::string_view name = key ? key : "";
+    auto entry = keys.find(name);
+    if (entry == keys.end())
+        entry = keys.emplace(std::string(name), XmlKeyCounters()).first;
+
+    switch (event)
+    {
+    case XmlMetricEvent::Lookup: ++entry->second.lookups; break;
+    case XmlMetricEvent::Miss: ++entry->second.misses; break;
+    case XmlMetricEvent::Conversion: ++entry->second.conversions; break;
+    case XmlMetricEvent::Failure: ++entry->second.failures; break;
+    }
+}
+
+XmlMetricsSnapshot XmlMetrics::snapshot()
+{
+    Registry& shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    XmlMetricsSnapshot result = shared.retired;
+    for (ThreadMetrics* thread : shared.threads)
+    {
+        std::lock_guard<std::mutex> threadLock(thread->mutex);
+        mergeInto(result, thread->classes);
+    }
+    return result;
+}
+
+void XmlMetrics::reset()
+{
+    Registry& shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    shared.retired = XmlMetricsSnapshot();
+    for (ThreadMetrics* thread : shared.threads)
+    {
+        std::lock_guard<std::mutex> threadLock(thread->mutex);
+        thread->classes.clear();
+    }
+}
+
+XmlMetricsScope::XmlMetricsScope(const std::type_info& type, XmlMetricsPhase phase)
+    : m_previous(currentType), m_phase(XmlMetrics::enabled() ? phase : XmlMetricsPhase::None)
+{
+    currentType = &type;
+    if (m_phase != XmlMetricsPhase::None)
+        m_start = std::chrono::steady_clock::now();
+}
+
+XmlMetricsScope::~XmlMetricsScope()
+{
+    if (m_phase != XmlMetricsPhase::None)
+    {
+        auto elapsed = std::chrono::steady_clock::now() - m_start;
+        uint64_t nanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+        ThreadMetrics& metrics = localMetrics();
+        std::lock_guard<std::mutex> lock(metrics.mutex);
+        ClassAccumulator& accumulator = metrics.classes[currentType];
+        (m_phase == XmlMetricsPhase::Serialize ? accumulator.serialize : accumulator.deserialize).add(nanoseconds);
+    }
+    currentType = m_previous;
+}
+#else
+void XmlMetrics::setEnabled(bool) {}
+void XmlMetrics::dispatch(XmlMetricEvent, const char*) {}
+XmlMetricsSnapshot XmlMetrics::snapshot() { return XmlMetricsSnapshot(); }
+void XmlMetrics::reset() {}
+#endif
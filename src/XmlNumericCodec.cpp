@@ -0,0 +1,60 @@
+#include "XmlNumericCodec.h"
+#include <cstring>
+
+size_t XmlNumericCodec::format(char* buffer, size_t size, bool value)
+{
+    const char* text = value ? "true" : "false";
+    size_t length = value ? 4 : 5;
+    if (size <= length)
+        return 0;
+    std::memcpy(buffer, text, length + 1);
+    return length;
+}
+
+bool XmlNumericCodec::parse(const char* text, bool& value)
+{
+    const char* first;
+    const char* last;
+    if (!trim(text, first, last))
+        return false;
+
+    static const char* const trueValues[] = { "true", "True", "TRUE" };
+    static const char* const falseValues[] = { "false", "False", "FALSE" };
+    size_t length = static_cast<size_t>(last - first);
+    for (const char* candidate : trueValues)
+    {
+        if (std::strlen(candidate) == length && std::memcmp(first, candidate, length) == 0)
+        {
+            value = true;
+            return true;
+        }
+    }
+    for (const char* candidate : falseValues)
+    {
+        if (std::strlen(candidate) == length && std::memcmp(first, candidate, length) == 0)
+        {
+            value = false;
+            return true;
+        }
+    }
+
+    long long number;
+    if (!parse(text, number))
+        return false;
+    value = number != 0;
+    return true;
+}
+
+bool XmlNumericCodec::trim(const char* text, const char*& first, const char*& last)
+{
+    if (!text)
+        return false;
+    auto isSpace = [](char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; };
+    first = text;
+    while (isSpace(*first))
+        ++first;
+    last = first + std::strlen(first);
+    while (last > first && isSpace(last[-1]))
+        --last;
+    return last > first;
+}
@@ -0,0 +1,140 @@
+#include "XmlPath.h"
+#include <cstring>
+
+XmlPath::XmlPath(std::string_view path) : m_text(path)
+{
+    m_valid = parse(path);
+    if (!m_valid)
+    {
+        m_steps.clear();
+        m_multiple = false;
+        XmlDiagnostics::report(XmlErrorCode::ParseFailed, nullptr, m_text.c_str(), "Invalid element path");
+    }
+}
+
+bool XmlPath::valid() const { return m_valid; }
+const std::string& XmlPath::text() const { return m_text; }
+bool XmlPath::multiple() const { return m_multiple; }
+
+tinyxml2::XMLElement* XmlPath::first(tinyxml2::XMLElement* root) const
+{
+    Iterator match(this, root);
+    return match.m_positions.empty() ? nullptr : match.m_positions.back();
+}
+
+XmlPath::Range XmlPath::select(tinyxml2::XMLElement* root) const
+{
+    return Range(Iterator(this, root), Iterator());
+}
+
+size_t XmlPath::count(tinyxml2::XMLElement* root) const
+{
+    size_t result = 0;
+    for (Iterator match(this, root); !match.m_positions.empty(); ++match)
+        ++result;
+    return result;
+}
+
+bool XmlPath::parse(std::string_view path)
+{
+    if (path.empty())
+        return false;
+    size_t start = 0;
+    while (start <= path.size())
+    {
+        size_t end = path.find('/', start);
+        if (end == std::string_view::npos)
+            end = path.size();
+        std::string_view part = path.substr(start, end - start);
+
+        Step step;
+        size_t bracket = part.find('[');
+        if (bracket != std::string_view::npos)
+        {
+            if (part.back() != ']' || bracket + 2 >= part.size())
+                return false;
+            std::string_view index = part.substr(bracket + 1, part.size() - bracket - 2);
+            if (index == "*")
+            {
+                step.index = AllChildren;
+                m_multiple = true;
+            }
+            else
+            {
+                size_t position = 0;
+                for (char c : index)
+                {
+                    if (c < '0' || c > '9' || position > (AllChildren - 10) / 10)
+                        return false;
+                    position = position * 10 + static_cast<size_t>(c - '0');
+                }
+                step.index = position;
+            }
+            part = part.substr(0, bracket);
+        }
+        if (part.empty() || part.find_first_of("[]") != std::string_view::npos)
+            return false;
+        step.name.assign(part.data(), part.size());
+        m_steps.push_back(std::move(step));
+        start = end + 1;
+    }
+    return true;
+}
+
+tinyxml2::XMLElement* XmlPath::next(size_t level, tinyxml2::XMLElement* parent, tinyxml2::XMLElement* current) const
+{
+    const Step& step = m_steps[level];
+    const char* name = step.name.c_str();
+    if (current)
+        return step.index == AllChildren ? current->NextSiblingElement(name) : nullptr;
+
+    tinyxml2::XMLElement* element = parent->FirstChildElement(name);
+    if (step.index != FirstChild && step.index != AllChildren)
+    {
+        for (size_t skip = step.index; element && skip > 0; --skip)
+            element = element->NextSiblingElement(name);
+    }
+    return element;
+}
+
+XmlPath::Iterator::Iterator(const XmlPath* path, tinyxml2::XMLElement* root) : m_path(path), m_root(root)
+{
+    if (!root || !path->m_valid)
+        return;
+    m_positions.assign(path->m_steps.size(), nullptr);
+    advance(0);
+}
+
+XmlPath::Iterator& XmlPath::Iterator::operator++()
+{
+    if (!m_positions.empty())
+        advance(m_positions.size() - 1);
+    return *this;
+}
+
+void XmlPath::Iterator::advance(size_t level)
+{
+    // Depth-first: move the deepest step that has another candidate and restart the steps below it
+    while (true)
+    {
+        tinyxml2::XMLElement* parent = level == 0 ? m_root : m_positions[level - 1];
+        tinyxml2::XMLElement* element = m_path->next(level, parent, m_positions[level]);
+        m_positions[level] = element;
+        if (element)
+        {
+            if (level + 1 == m_positions.size())
+                return;
+            ++level;
+            m_positions[level] = nullptr;
+        }
+        else
+        {
+            if (level == 0)
+            {
+                m_positions.clear();
+                return;
+            }
+            --level;
+        }
+    }
+}
@@ -0,0 +1,291 @@
+#include "XmlRecordReader.h"
+#include <cctype>
+#include <cstring>
+#include "XmlDiagnostics.h"
+
+XmlRecordReader::XmlRecordReader(const std::string& filename, const std::string& recordPath)
+    : m_file(std::fopen(filename.c_str(), "rb")), m_data(nullptr), m_size(0), m_pos(0), m_mark(NoMark), m_tag(0),
+    m_depth(0), m_matched(0), m_capturing(false), m_error(false), m_count(0),
+    m_lastValid(false), m_invalid(0)
+{
+    if (!m_file)
+    {
+        XmlDiagnostics::report(XmlErrorCode::IoFailed, nullptr, filename.c_str(), "Failed to open file");
+        m_error = true;
+    }
+    setPath(recordPath);
+}
+
+XmlRecordReader::XmlRecordReader(const char* data, size_t size, const std::string& recordPath)
+    : m_file(nullptr), m_data(data), m_size(data ? size : 0), m_pos(0), m_mark(NoMark), m_tag(0),
+    m_depth(0), m_matched(0), m_capturing(false), m_error(false), m_count(0),
+    m_lastValid(false), m_invalid(0)
+{
+    setPath(recordPath);
+}
+
+XmlRecordReader::XmlRecordReader(const XmlMappedFile& file, const std::string& recordPath)
+    : XmlRecordReader(file.data(), file.size(), recordPath)
+{
+}
+
+XmlRecordReader::~XmlRecordReader()
+{
+    if (m_file)
+        std::fclose(m_file);
+}
+
+bool XmlRecordReader::isOpen() const { return m_file != nullptr || m_data != nullptr; }
+bool XmlRecordReader::hasError() const { return m_error; }
+size_t XmlRecordReader::recordCount() const { return m_count; }
+bool XmlRecordReader::lastRecordValid() const { return m_lastValid; }
+size_t XmlRecordReader::invalidCount() const { return m_invalid; }
+
+tinyxml2::XMLElement* XmlRecordReader::nextElement()
+{
+    m_document.Clear();
+    while (!m_error)
+    {
+        // Character data between tags is only needed inside a record, where it stays in the buffer
+        if (!skipTo('<'))
+        {
+            if (m_depth > 0)
+                fail("Unexpected end of input inside element");
+            return nullptr;
+        }
+
+        m_tag = m_pos - 1;
+        if (!m_capturing)
+            m_mark = m_tag;
+
+        int c = get();
+        if (c == '?')
+        {
+            if (!skipPast("?>"))
+                fail("Unterminated processing instruction");
+        }
+        else if (c == '!')
+        {
+            c = get();
+            if (c == '-')
+            {
+                if (!skipPast("-->"))
+                    fail("Unterminated comment");
+            }
+            else if (c == '[')
+            {
+                if (!skipPast("]]>"))
+                    fail("Unterminated CDATA section");
+            }
+            else if (!skipDeclaration())
+            {
+                fail("Unterminated declaration");
+            }
+        }
+        else if (c == '/')
+        {
+            if (!skipTo('>'))
+                fail("Unterminated end tag");
+            else if (m_depth == 0)
+                fail("Unbalanced end tag");
+            else if (closeElement())
+                return m_document.RootElement();
+        }
+        else if (c != EOF)
+        {
+            // Start tag: skip attributes, honoring quoted values that may contain '>'
+            int previous = 0;
+            while (c != '>' && c != EOF)
+            {
+                if ((c == '"' || c == '\'') && !skipTo(static_cast<char>(c)))
+                {
+                    c = EOF;
+                    break;
+                }
+                previous = c;
+                c = get();
+            }
+            if (c == EOF)
+            {
+                fail("Unterminated start tag");
+                continue;
+            }
+
+            // Tag bytes are retained by m_mark, so the name can be read in place
+            const char* name = m_data + m_tag + 1;
+            size_t length = 0;
+            while (name[length] != '>' && name[length] != '/' && !std::isspace(static_cast<unsigned char>(name[length])))
+                ++length;
+
+            ++m_depth;
+            if (!m_capturing && m_matched + 1 == m_depth && m_depth <= m_path.size()
+                && m_path[m_depth - 1].compare(0, std::string::npos, name, length) == 0)
+            {
+                m_matched = m_depth;
+                if (m_matched == m_path.size())
+                    m_capturing = true;
+            }
+
+            if (previous == '/' && closeElement())
+                return m_document.RootElement();
+        }
+        else
+        {
+            fail("Unexpected end of input after '<'");
+        }
+
+        if (!m_capturing)
+            m_mark = NoMark;
+    }
+    return nullptr;
+}
+
+bool XmlRecordReader::next(XMLSerializable& record)
+{
+    tinyxml2::XMLElement* element = nextElement();
+    if (!element)
+        return false;
+    // The scan goes on past a bad record; its result is kept for lastRecordValid()
+    setRecordValid(record.deserialize(element));
+    return true;
+}
+
+void XmlRecordReader::setRecordValid(bool valid)
+{
+    m_lastValid = valid;
+    if (!valid)
+        ++m_invalid;
+}
+
+void XmlRecordReader::setPath(const std::string& recordPath)
+{
+    size_t begin = 0;
+    while (begin <= recordPath.size())
+    {
+        size_t end = recordPath.find('/', begin);
+        if (end == std::string::npos)
+            end = recordPath.size();
+        if (end > begin)
+            m_path.push_back(recordPath.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    if (m_path.empty())
+        fail("Record path is empty");
+}
+
+// Closes the element whose end tag (or self-closing start tag) just ended at m_pos. Returns true
+// when that completes a record, which is then parsed into m_document.
+bool XmlRecordReader::closeElement()
+{
+    bool completed = m_capturing && m_depth == m_path.size();
+    if (m_matched == m_depth)
+        --m_matched;
+    --m_depth;
+    if (!completed)
+        return false;
+
+    m_capturing = false;
+    const char* record = m_data + m_mark;
+    size_t length = m_pos - m_mark;
+    m_mark = NoMark;
+    if (m_document.Parse(record, length) != tinyxml2::XML_SUCCESS)
+    {
+        fail(std::string("Failed to parse record: ") + m_document.ErrorStr());
+        return false;
+    }
+    ++m_count;
+    return true;
+}
+
+// Refills the buffer from the file, keeping everything from m_mark onward. The buffer therefore
+// grows to hold at most one record.
+bool XmlRecordReader::fill()
+{
+    if (!m_file)
+        return false;
+
+    size_t keep = m_mark == NoMark ? m_size : m_mark;
+    size_t kept = m_size - keep;
+    if (keep > 0 && kept > 0)
+        std::memmove(m_storage.data(), m_storage.data() + keep, kept);
+    m_pos -= keep;
+    m_tag -= keep;
+    if (m_mark != NoMark)
+        m_mark = 0;
+
+    if (m_storage.size() < kept + BufferSize)
+        m_storage.resize(kept + BufferSize);
+    size_t read = std::fread(m_storage.data() + kept, 1, m_storage.size() - kept, m_file);
+    m_data = m_storage.data();
+    m_size = kept + read;
+    return read > 0;
+}
+
+int XmlRecordReader::get()
+{
+    if (m_pos == m_size && !fill())
+        return EOF;
+    return static_cast<unsigned char>(m_data[m_pos++]);
+}
+
+bool XmlRecordReader::skipTo(char target)
+{
+    for (;;)
+    {
+        if (m_pos < m_size)
+        {
+            const void* found = std::memchr(m_data + m_pos, target, m_size - m_pos);
+            if (found)
+            {
+                m_pos = static_cast<size_t>(static_cast<const char*>(found) - m_data) + 1;
+                return true;
+            }
+            m_pos = m_size;
+        }
+        if (!fill())
+            return false;
+    }
+}
+
+bool XmlRecordReader::skipPast(const char* terminator)
+{
+    // Terminators are at most three characters; compare against a sliding window
+    const size_t length = std::strlen(terminator);
+    char window[3] = { 0, 0, 0 };
+    for (int c = get(); c != EOF; c = get())
+    {
+        window[0] = window[1];
+        window[1] = window[2];
+        window[2] = static_cast<char>(c);
+        if (std::memcmp(window + 3 - length, terminator, length) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool XmlRecordReader::skipDeclaration()
+{
+    // <!DOCTYPE ...> may carry an internal subset in brackets containing '>'
+    int brackets = 0;
+    for (int c = get(); c != EOF; c = get())
+    {
+        if (c == '[')
+            ++brackets;
+        else if (c == ']')
+            --brackets;
+        else if (c == '"' || c == '\'')
+        {
+            if (!skipTo(static_cast<char>(c)))
+                return false;
+        }
+        else if (c == '>' && brackets <= 0)
+            return true;
+    }
+    return false;
+}
+
+void XmlRecordReader::fail(const std::string& message)
+{
+    XmlDiagnostics::report(XmlErrorCode::ParseFailed, nullptr, nullptr, message.c_str());
+    m_error = true;
+}
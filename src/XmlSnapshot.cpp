@@ -0,0 +1,21 @@
+#include "XmlSnapshot.h"
+
+uint64_t xmlSnapshotHash(const void* data, size_t size, uint64_t seed)
+{
+    const uint64_t prime = 1099511628211ull;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+
+    // Whole words first; the shift folds high bits down, which the multiplication alone does not
+    for (; size >= 8; bytes += 8, size -= 8)
+    {
+        uint64_t word = 0;
+        for (size_t byte = 0; byte < 8; ++byte)
+            word |= static_cast<uint64_t>(bytes[byte]) << (byte * 8);
+        hash = (hash ^ word) * prime;
+        hash ^= hash >> 32;
+    }
+    for (; size > 0; ++bytes, --size)
+        hash = (hash ^ *bytes) * prime;
+    return hash;
+}
@@ -0,0 +1,161 @@
+#include "XmlSnapshotCache.h"
+#include "XmlDiagnostics.h"
+#include "XmlMappedFile.h"
+#include "XMLSerializable.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace
+{
+    // "TXHSNAP" plus the format version in the last byte
+    const uint64_t SnapshotMagic = 0x0150414e53485854ull;
+}
+
+struct XmlSnapshotCache::SourceKey
+{
+    uint64_t size = 0;
+    uint64_t modified = 0;      // Nanoseconds since the file clock's epoch
+    uint64_t hash = 0;
+
+    bool load(const std::string& filename, const XmlMappedFile& file)
+    {
+        std::error_code error;
+        std::filesystem::file_time_type time = std::filesystem::last_write_time(filename, error);
+        if (error)
+            return false;
+        size = file.size();
+        modified = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+        hash = xmlSnapshotHash(file.data(), file.size());
+        return true;
+    }
+};
+
+XmlSnapshotCache::XmlSnapshotCache(std::string suffix) : m_suffix(std::move(suffix)), m_lastSource(Source::None) {}
+
+bool XmlSnapshotCache::load(const std::string& filename, const char* rootName, XMLSerializable& object)
+{
+    m_lastSource = Source::None;
+    XmlMappedFile file;
+    if (!file.open(filename))
+        return false;
+
+    SourceKey key;
+    bool keyed = key.load(filename, file);
+    std::string path = snapshotPath(filename);
+    if (keyed && readSnapshot(path, key, rootName, object))
+    {
+        m_lastSource = Source::Snapshot;
+        return true;
+    }
+
+    // Deserializing sets every field found in the XML, so values left by a rejected snapshot do
+    // not survive
+    tinyxml2::XMLDocument document;
+    if (file.size() == 0 || document.Parse(file.data(), file.size()) != tinyxml2::XML_SUCCESS)
+    {
+        XmlDiagnostics::report(XmlErrorCode::ParseFailed, nullptr, filename.c_str(),
+            file.size() == 0 ? "Document is empty" : document.ErrorStr());
+        return false;
+    }
+    tinyxml2::XMLElement* root = document.RootElement();
+    if (!root || std::strcmp(root->Name(), rootName) != 0)
+    {
+        XmlDiagnostics::report(XmlErrorCode::ElementNotFound, nullptr, rootName, "Root element not found");
+        return false;
+    }
+
+    m_lastSource = Source::Xml;
+    bool success = object.deserialize(root);
+    if (success && keyed)
+        writeSnapshot(path, key, rootName, object);
+    return success;
+}
+
+bool XmlSnapshotCache::store(const std::string& filename, const char* rootName, const XMLSerializable& object)
+{
+    XmlMappedFile file;
+    if (!file.open(filename))
+        return false;
+
+    SourceKey key;
+    if (!key.load(filename, file))
+    {
+        XmlDiagnostics::report(XmlErrorCode::IoFailed, nullptr, filename.c_str(), "Failed to read modification time");
+        return false;
+    }
+    return writeSnapshot(snapshotPath(filename), key, rootName, object);
+}
+
+XmlSnapshotCache::Source XmlSnapshotCache::lastSource() const { return m_lastSource; }
+
+std::string XmlSnapshotCache::snapshotPath(const std::string& filename) const { return filename + m_suffix; }
+
+bool XmlSnapshotCache::readSnapshot(const std::string& path, const SourceKey& key, const char* rootName, XMLSerializable& object)
+{
+    // A missing snapshot is the normal first start, not an error
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(path, error))
+        return false;
+    XmlMappedFile snapshot;
+    if (!snapshot.open(path))
+        return false;
+
+    XmlSnapshotReader reader(snapshot.data(), snapshot.size());
+    uint64_t magic, size, modified, hash, payloadHash;
+    std::string root;
+    if (!reader.readFixed(magic, sizeof(magic)) || magic != SnapshotMagic
+        || !reader.readVarint(size) || size != key.size
+        || !reader.readFixed(modified, sizeof(modified)) || modified != key.modified
+        || !reader.readFixed(hash, sizeof(hash)) || hash != key.hash
+        || !reader.read(root) || root != rootName
+        || !reader.readFixed(payloadHash, sizeof(payloadHash))
+        || payloadHash != xmlSnapshotHash(reader.position(), reader.remaining()))
+    {
+        return false;
+    }
+    return object.readSnapshot(reader) && reader.atEnd();
+}
+
+bool XmlSnapshotCache::writeSnapshot(const std::string& path, const SourceKey& key, const char* rootName, const XMLSerializable& object)
+{
+    m_payload.buffer().clear();
+    if (!object.writeSnapshot(m_payload))
+        return false;
+
+    m_header.buffer().clear();
+    m_header.writeFixed(SnapshotMagic, sizeof(uint64_t));
+    m_header.writeVarint(key.size);
+    m_header.writeFixed(key.modified, sizeof(uint64_t));
+    m_header.writeFixed(key.hash, sizeof(uint64_t));
+    m_header.write(std::string(rootName));
+    m_header.writeFixed(xmlSnapshotHash(m_payload.data().data(), m_payload.data().size()), sizeof(uint64_t));
+
+    // Written under a unique name and renamed into place, so readers never see a partial snapshot
+    std::string temporary = path + ".tmp" + std::to_string(std::random_device()());
+    {
+        std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+        output.write(m_header.data().data(), static_cast<std::streamsize>(m_header.data().size()));
+        output.write(m_payload.data().data(), static_cast<std::streamsize>(m_payload.data().size()));
+        output.close();
+        if (!output)
+        {
+            std::error_code ignored;
+            std::filesystem::remove(temporary, ignored);
+            XmlDiagnostics::report(XmlErrorCode::IoFailed, nullptr, path.c_str(), "Failed to write snapshot");
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error)
+    {
+        std::filesystem::remove(temporary, error);
+        XmlDiagnostics::report(XmlErrorCode::IoFailed, nullptr, path.c_str(), "Failed to replace snapshot");
+        return false;
+    }
+    return true;
+}
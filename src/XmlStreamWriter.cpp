@@ -0,0 +1,167 @@
+#include "XmlStreamWriter.h"
+#include "XMLSerializable.h"
+
+XmlStreamWriter::XmlStreamWriter(const std::string& filename, bool compact)
+    : m_file(std::fopen(filename.c_str(), "wb")), m_filename(filename), m_ownsFile(true), m_compact(compact), m_depth(0),
+    m_baseDepth(0), m_printer(m_file, compact)
+{
+    if (!m_file)
+        XmlDiagnostics::report(XmlErrorCode::IoFailed, nullptr, filename.c_str(), "Failed to open file");
+}
+
+XmlStreamWriter::XmlStreamWriter(const char* filename, bool compact) : XmlStreamWriter(std::string(filename), compact) {}
+
+XmlStreamWriter::XmlStreamWriter(FILE* file, bool compact)
+    : m_file(file), m_ownsFile(false), m_compact(compact), m_depth(0), m_baseDepth(0), m_printer(file, compact)
+{
+}
+
+XmlStreamWriter::XmlStreamWriter(bool compact)
+    : m_file(nullptr), m_ownsFile(false), m_compact(compact), m_depth(0), m_baseDepth(0), m_printer(nullptr, compact)
+{
+}
+
+XmlStreamWriter::XmlStreamWriter(bool compact, int depth)
+    : m_file(nullptr), m_ownsFile(false), m_compact(compact), m_depth(0), m_baseDepth(depth),
+    m_printer(nullptr, compact, depth)
+{
+    // Content continues an element of another writer, so the first element starts on a new line
+    m_printer.ClearBuffer(false);
+}
+
+XmlStreamWriter::~XmlStreamWriter()
+{
+    if (m_depth > 0)
+        XmlDiagnostics::report(XmlErrorCode::InvalidState, nullptr, nullptr, "Elements left open in stream writer");
+    if (m_ownsFile && m_file)
+        std::fclose(m_file);
+}
+
+bool XmlStreamWriter::close()
+{
+    if (!m_file)
+        return isOpen();
+
+    // The printer writes through stdio, so errors surface in the stream state or when flushing
+    bool success = std::fflush(m_file) == 0 && !std::ferror(m_file);
+    if (m_ownsFile)
+    {
+        success = std::fclose(m_file) == 0 && success;
+        m_file = nullptr;
+    }
+    if (!success)
+        XmlDiagnostics::report(XmlErrorCode::IoFailed, nullptr, m_filename.empty() ? nullptr : m_filename.c_str(), "Failed to write file");
+    return success;
+}
+
+bool XmlStreamWriter::isOpen() const { return m_file != nullptr || !m_ownsFile; }
+bool XmlStreamWriter::isCompact() const { return m_compact; }
+int XmlStreamWriter::depth() const { return m_baseDepth + m_depth; }
+
+bool XmlStreamWriter::openElement(const char* name)
+{
+    if (!isOpen())
+    {
+        XmlDiagnostics::report(XmlErrorCode::IoFailed, nullptr, nullptr, "Stream writer has no output");
+        return false;
+    }
+    m_printer.OpenElement(name, m_compact);
+    ++m_depth;
+    return true;
+}
+
+bool XmlStreamWriter::closeElement()
+{
+    if (m_depth == 0)
+    {
+        XmlDiagnostics::report(XmlErrorCode::InvalidState, nullptr, nullptr, "No open element to close");
+        return false;
+    }
+    if (!isOpen())
+    {
+        XmlDiagnostics::report(XmlErrorCode::IoFailed, nullptr, nullptr, "Stream writer has no output");
+        return false;
+    }
+    m_printer.CloseElement(m_compact);
+    --m_depth;
+    return true;
+}
+
+bool XmlStreamWriter::write(const char* name, const std::string& value) { return writeText(name, value.c_str()); }
+bool XmlStreamWriter::write(const char* name, const char* value) { return writeText(name, value); }
+bool XmlStreamWriter::write(const char* name, int value) { return writeNumber(name, value); }
+bool XmlStreamWriter::write(const char* name, unsigned int value) { return writeNumber(name, value); }
+bool XmlStreamWriter::write(const char* name, int64_t value) { return writeNumber(name, value); }
+bool XmlStreamWriter::write(const char* name, uint64_t value) { return writeNumber(name, value); }
+bool XmlStreamWriter::write(const char* name, bool value) { return writeNumber(name, value); }
+bool XmlStreamWriter::write(const char* name, double value) { return writeNumber(name, value); }
+bool XmlStreamWriter::write(const char* name, float value) { return writeNumber(name, value); }
+
+bool XmlStreamWriter::write(const char* name, const XMLSerializable& serializable)
+{
+    if (!openElement(name))
+        return false;
+    bool success = serializable.serializeStream(*this);
+    return closeElement() && success;
+}
+
+bool XmlStreamWriter::write(const tinyxml2::XMLElement* element)
+{
+    if (!element)
+    {
+        XmlDiagnostics::report(XmlErrorCode::NullElement, nullptr, nullptr, "Element is null");
+        return false;
+    }
+    if (!isOpen())
+    {
+        XmlDiagnostics::report(XmlErrorCode::IoFailed, nullptr, nullptr, "Stream writer has no output");
+        return false;
+    }
+    return element->Accept(&m_printer);
+}
+
+bool XmlStreamWriter::writeRaw(const char* data, size_t size)
+{
+    if (!isOpen())
+    {
+        XmlDiagnostics::report(XmlErrorCode::IoFailed, nullptr, nullptr, "Stream writer has no output");
+        return false;
+    }
+    m_printer.writeRaw(data, size);
+    return true;
+}
+
+const char* XmlStreamWriter::buffer() const { return m_printer.CStr(); }
+size_t XmlStreamWriter::size() const { return m_printer.CStrSize() > 0 ? m_printer.CStrSize() - 1 : 0; }
+void XmlStreamWriter::clearBuffer() { m_printer.ClearBuffer(); }
+
+tinyxml2::XMLElement* XmlStreamWriter::scratchElement()
+{
+    m_scratch.Clear();
+    tinyxml2::XMLElement* element = m_scratch.NewElement("scratch");
+    m_scratch.InsertEndChild(element);
+    return element;
+}
+
+void XmlStreamWriter::writeScratch()
+{
+    const tinyxml2::XMLElement* element = m_scratch.RootElement();
+    if (element)
+    {
+        for (const tinyxml2::XMLAttribute* attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+            m_printer.PushAttribute(attribute->Name(), attribute->Value());
+        for (const tinyxml2::XMLNode* child = element->FirstChild(); child; child = child->NextSibling())
+            child->Accept(&m_printer);
+    }
+    m_scratch.Clear();
+}
+
+tinyxml2::XMLPrinter& XmlStreamWriter::printer() { return m_printer; }
+
+bool XmlStreamWriter::writeText(const char* name, const char* text)
+{
+    if (!openElement(name))
+        return false;
+    m_printer.PushText(text);
+    return closeElement();
+}
@@ -0,0 +1,133 @@
+#include "XmlThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace
+{
+    // State of one run() call. Shared with the queued helpers, which may only get to run after the
+    // call has returned; they then find no index left and never touch the task.
+    struct Batch
+    {
+        std::atomic<size_t> next{ 0 };
+        size_t count = 0;
+        size_t finished = 0;
+        const std::function<void(size_t)>* task = nullptr;
+        std::exception_ptr error;
+        size_t errorIndex = 0;
+        std::mutex mutex;
+        std::condition_variable done;
+
+        void process()
+        {
+            for (size_t index = next.fetch_add(1); index < count; index = next.fetch_add(1))
+            {
+                std::exception_ptr caught;
+                try
+                {
+                    (*task)(index);
+                }
+                catch (...)
+                {
+                    caught = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                if (caught && (!error || index < errorIndex))
+                {
+                    error = caught;
+                    errorIndex = index;
+                }
+                if (++finished == count)
+                    done.notify_all();
+            }
+        }
+    };
+}
+
+XmlThreadPool::XmlThreadPool(size_t threads)
+    : m_stop(false)
+{
+    if (threads == 0)
+    {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        threads = hardware > 1 ? hardware - 1 : 0;
+    }
+    m_threads.reserve(threads);
+    for (size_t i = 0; i < threads; ++i)
+        m_threads.emplace_back([this]() { work(); });
+}
+
+XmlThreadPool::~XmlThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& thread : m_threads)
+        thread.join();
+}
+
+size_t XmlThreadPool::concurrency() const
+{
+    return m_threads.size() + 1;
+}
+
+void XmlThreadPool::run(size_t count, const std::function<void(size_t)>& task)
+{
+    if (count == 0)
+        return;
+
+    auto batch = std::make_shared<Batch>();
+    batch->count = count;
+    batch->task = &task;
+
+    size_t helpers = std::min(m_threads.size(), count - 1);
+    for (size_t i = 0; i < helpers; ++i)
+        post([batch]() { batch->process(); });
+    batch->process();
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(batch->mutex);
+        batch->done.wait(lock, [&batch]() { return batch->finished == batch->count; });
+        // Taken out of the batch, which helpers that have not started yet may still release
+        error = std::move(batch->error);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void XmlThreadPool::post(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(job));
+    }
+    m_wake.notify_one();
+}
+
+XmlThreadPool& XmlThreadPool::shared()
+{
+    static XmlThreadPool pool;
+    return pool;
+}
+
+void XmlThreadPool::work()
+{
+    for (;;)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+            if (m_jobs.empty())
+                return;
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+        job();
+    }
+}